@@ -9,6 +9,7 @@
 #include <fmt/ranges.h>
 #include <fmt/std.h>
 #include <iostream>
+#include <random>
 
 namespace Model {
 static std::istream &
@@ -33,6 +34,84 @@ operator>>(std::istream &in, Model::AnalyticModel &model)
 }
 } // namespace Model
 
+namespace Simulation {
+static std::istream &
+operator>>(std::istream &in, EventSetType &event_set)
+{
+  std::string token;
+  in >> token;
+  if (token == "binary_heap")
+  {
+    event_set = EventSetType::BinaryHeap;
+  }
+  else if (token == "calendar_queue")
+  {
+    event_set = EventSetType::CalendarQueue;
+  }
+  else
+  {
+    throw boost::program_options::validation_error(
+        boost::program_options::validation_error::invalid_option_value, "Invalid EventSetType");
+  }
+  return in;
+}
+
+static std::istream &
+operator>>(std::istream &in, ExponentialSamplerType &sampler)
+{
+  std::string token;
+  in >> token;
+  if (token == "ziggurat")
+  {
+    sampler = ExponentialSamplerType::Ziggurat;
+  }
+  else if (token == "reference")
+  {
+    sampler = ExponentialSamplerType::Reference;
+  }
+  else
+  {
+    throw boost::program_options::validation_error(
+        boost::program_options::validation_error::invalid_option_value,
+        "Invalid ExponentialSamplerType");
+  }
+  return in;
+}
+
+static std::istream &
+operator>>(std::istream &in, RunMode &run_mode)
+{
+  std::string token;
+  in >> token;
+  if (token == "events")
+  {
+    run_mode = RunMode::Events;
+  }
+  else if (token == "ticks")
+  {
+    run_mode = RunMode::Ticks;
+  }
+  else if (token == "states")
+  {
+    run_mode = RunMode::States;
+  }
+  else if (token == "leaps")
+  {
+    run_mode = RunMode::Leaps;
+  }
+  else if (token == "auto")
+  {
+    run_mode = RunMode::Auto;
+  }
+  else
+  {
+    throw boost::program_options::validation_error(
+        boost::program_options::validation_error::invalid_option_value, "Invalid RunMode");
+  }
+  return in;
+}
+} // namespace Simulation
+
 [[maybe_unused]]
 static std::istream &
 operator>>(std::istream &in, Mode &mode)
@@ -111,7 +190,70 @@ prepare_options_description()
                         " - KRFixedReqSize\n"
                         "Parameter can be repeated")
     ("random,r",  po::value<bool>()->default_value(false),
-                        "use random seed");
+                        "use random seed")
+    ("coupled-sweep", po::value<bool>()->default_value(false),
+                        "common random numbers for the intensities of a scenario file: they share "
+                        "the random streams, the Poisson arrivals are drawn at the highest "
+                        "intensity and thinned. Every point is still a separate run and draws "
+                        "A_max/A candidate arrivals with an extra uniform each, e.g. 4.5 times "
+                        "the draws of the lowest point for --start 0.4 --stop 1.8")
+    ("event-set", po::value<Simulation::EventSetType>()
+                    ->default_value(Simulation::EventSetType::CalendarQueue, "calendar_queue"),
+                        "Data structure holding pending events of the simulation:\n"
+                        " - calendar_queue\n"
+                        " - binary_heap (reference)")
+    ("run-mode", po::value<Simulation::RunMode>()
+                   ->default_value(Simulation::RunMode::Auto, "auto"),
+                        "Main loop of the simulation:\n"
+                        " - auto (states if possible, events otherwise)\n"
+                        " - states (Poisson sources without compression)\n"
+                        " - leaps (approximate states, tau-leaping far from the capacity)\n"
+                        " - events\n"
+                        " - ticks (reference)")
+    ("exponential", po::value<Simulation::ExponentialSamplerType>()
+                      ->default_value(Simulation::ExponentialSamplerType::Ziggurat, "ziggurat"),
+                        "Sampler of the inter-arrival and holding times:\n"
+                        " - ziggurat\n"
+                        " - reference")
+    ("leap-epsilon", po::value<double>()->default_value(0.1),
+                        "fraction of the free capacity and of the occupancy of the groups that may "
+                        "change during a leap in the leaps run mode")
+    ("restart-thresholds", po::value<std::vector<double>>()->multitoken(),
+                        "RESTART splitting for rare blocking in the states run mode, increasing "
+                        "thresholds of the total occupancy of the RESTART groups")
+    ("restart-retrials", po::value<std::vector<size_t>>()->multitoken(),
+                        "number of retrials at every RESTART threshold, a single value applies "
+                        "to all of them (default 4)")
+    ("restart-groups", po::value<std::vector<std::string>>()->multitoken(),
+                        "groups whose occupancy is the RESTART importance (default all groups)")
+    ("restart-batches", po::value<size_t>()->default_value(20),
+                        "number of batches giving the confidence intervals of the RESTART "
+                        "estimates")
+    ("precision", po::value<double>()->default_value(0.0),
+                        "stop the simulation when the 95% confidence intervals of P_loss and "
+                        "P_block have the given relative half-width (0 - disabled)")
+    ("min-lost", po::value<uint64_t>()->default_value(0),
+                        "stop the simulation when every traffic class lost the given number of "
+                        "requests (0 - disabled)")
+    ("epoch-duration", po::value<time_type<>>()->default_value(0),
+                        "divide the simulation into epochs of the given duration which give the "
+                        "confidence intervals (0 - no epochs, 1000 if a stop condition or the "
+                        "control variates are given)")
+    ("warmup-epochs", po::value<size_t>()->default_value(0),
+                        "number of epochs excluded from the stats")
+    ("detect-warmup", po::value<bool>()->default_value(false),
+                        "detect the end of the warm-up (MSER-5 on the occupancy of the groups) and "
+                        "exclude it from the stats, replaces --warmup-epochs")
+    ("control-variates", po::value<bool>()->default_value(false),
+                        "adjust the epoch estimates of P_loss and P_block with the offered volume "
+                        "of the Poisson sources and the occupancy of the primary groups given by "
+                        "the analytical model as control variates")
+    ("hybrid-layers", po::value<std::vector<Layer>>()->multitoken(),
+                        "hybrid simulation, the layers computed with the analytical model (the "
+                        "first of the analytic_model) and replaced by the synthetic sources of "
+                        "their overflow traffic")
+    ("warmup-sample-interval", po::value<time_type<>>()->default_value(10),
+                        "time between the samples of the occupancy used to detect the warm-up");
   /* clang-format on */
   return desc;
 }
@@ -123,16 +265,56 @@ parse_args(const boost::program_options::variables_map &vm)
   CLIOptions cli;
   cli.help = vm.count("help") > 0;
   cli.use_random_seed = vm["random"].as<bool>();
+  if (cli.use_random_seed)
+  {
+    std::random_device rd;
+    cli.seed = rd();
+  }
   cli.quiet = vm.count("quiet") > 0;
   cli.output_file = vm["output-file"].as<std::string>();
   cli.output_dir = vm["output-dir"].as<std::string>();
   cli.parallel = vm["parallel"].as<bool>();
+  cli.coupled_sweep = vm["coupled-sweep"].as<bool>();
   cli.duration = Duration{vm["duration"].as<time_type<>>()};
   cli.A_start = Simulation::Intensity{vm["start"].as<intensity_t<>>()};
   cli.A_stop = Simulation::Intensity{vm["stop"].as<intensity_t<>>()};
   cli.A_step = Simulation::Intensity{vm["step"].as<intensity_t<>>()};
   cli.count = vm["count"].as<int>();
   cli.modes = vm["mode"].as<Modes>();
+  cli.event_set = vm["event-set"].as<Simulation::EventSetType>();
+  cli.run_mode = vm["run-mode"].as<Simulation::RunMode>();
+  cli.exponential = vm["exponential"].as<Simulation::ExponentialSamplerType>();
+  cli.leaps.epsilon = vm["leap-epsilon"].as<double>();
+  if (vm.count("restart-thresholds") > 0)
+  {
+    cli.restart.thresholds = vm["restart-thresholds"].as<std::vector<double>>();
+    cli.restart.retrials = vm.count("restart-retrials") > 0
+                               ? vm["restart-retrials"].as<std::vector<size_t>>()
+                               : std::vector<size_t>{4};
+    if (vm.count("restart-groups") > 0)
+    {
+      for (const auto &name : vm["restart-groups"].as<std::vector<std::string>>())
+      {
+        cli.restart.groups.emplace_back(name);
+      }
+    }
+    cli.restart.batches = vm["restart-batches"].as<size_t>();
+  }
+  cli.stop_condition.relative_precision = vm["precision"].as<double>();
+  cli.stop_condition.min_lost = vm["min-lost"].as<uint64_t>();
+  cli.epochs.duration = Duration{vm["epoch-duration"].as<time_type<>>()};
+  cli.epochs.warmup = vm["warmup-epochs"].as<size_t>();
+  cli.warmup_detection.enabled = vm["detect-warmup"].as<bool>();
+  cli.warmup_detection.sample_interval = Duration{vm["warmup-sample-interval"].as<time_type<>>()};
+  cli.control_variates = vm["control-variates"].as<bool>();
+  if (vm.count("hybrid-layers") > 0)
+  {
+    cli.hybrid_layers = vm["hybrid-layers"].as<std::vector<Layer>>();
+  }
+  if ((cli.stop_condition.enabled() || cli.control_variates) && !cli.epochs.enabled())
+  {
+    cli.epochs.duration = Duration{1'000};
+  }
 
   cli.analytic_models = [&vm]() -> AnalyticModels {
     if (vm.count("analytic_model") > 0)
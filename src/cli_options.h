@@ -1,6 +1,7 @@
 #pragma once
 
 #include "model/common.h"
+#include "simulation/common.h"
 #include "types/types.h"
 
 #include <boost/program_options/options_description.hpp>
@@ -18,10 +19,13 @@ struct CLIOptions
 {
   bool                  help = false;
   bool                  use_random_seed = false;
+  // Drawn once per invocation, all the scenarios derive their streams from it.
+  uint64_t              seed = 0;
   bool                  quiet = false;
   std::string           output_file{};
   std::string           output_dir{};
   bool                  parallel = false;
+  bool                  coupled_sweep = false;
   Duration              duration{};
   Simulation::Intensity A_start{};
   Simulation::Intensity A_stop{};
@@ -30,6 +34,23 @@ struct CLIOptions
   AnalyticModels        analytic_models{};
   int                   count{};
 
+  Simulation::EventSetType  event_set{Simulation::EventSetType::CalendarQueue};
+  Simulation::RunMode       run_mode{Simulation::RunMode::Auto};
+  Simulation::LeapSettings  leaps{};
+
+  Simulation::RestartSettings restart{};
+
+  Simulation::ExponentialSamplerType exponential{Simulation::ExponentialSamplerType::Ziggurat};
+
+  Simulation::EpochSettings epochs{};
+  Simulation::StopCondition stop_condition{};
+
+  Simulation::WarmupDetection warmup_detection{};
+
+  bool control_variates = false;
+
+  std::vector<Layer> hybrid_layers{};
+
   std::vector<std::string> append_scenario_files{};
   std::vector<std::string> scenario_files{};
   std::vector<std::string> scenarios_dirs{};
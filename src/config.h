@@ -4,6 +4,8 @@ namespace Config {
 inline constexpr bool constant_seed = false;
 inline constexpr bool logger_enabled = true;
 inline constexpr bool assert_enabled = true;
+// Loads keep the indices of all the groups they visited (see Simulation::LoadPath).
+inline constexpr bool record_load_path = true;
 #if SIM_DEBUG == 1
 inline constexpr bool debug_mpfr = true;
 inline constexpr bool debug_logger_enabled = true;
@@ -3,9 +3,105 @@
 
 #include "logger.h"
 
-#include <boost/math/special_functions.hpp>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
 
 namespace Math {
+namespace {
+//----------------------------------------------------------------------
+// Lazily grown Pascal triangle, rows_[n][k] is n over k for k <= min(n,
+// columns_). The rows and the columns grow by doubling up to the limits, the
+// coefficients beyond them are computed directly and not cached. The
+// combinatorial model asks for k up to the number of the components, but for n
+// up to the capacity of the group. The full triangle holds about 135k numbers
+// of up to 256 bits, which takes about 12 MB.
+class BinomialCoefficients
+{
+  static constexpr uint64_t max_rows = 1U << 12U;
+  static constexpr uint64_t max_columns = 32;
+
+  std::shared_mutex                     mutex_;
+  std::vector<std::vector<mp::cpp_int>> rows_{std::vector<mp::cpp_int>{1}};
+  uint64_t                              columns_ = 0;
+
+  void extend_row(uint64_t n)
+  {
+    auto &row = rows_[n];
+    for (uint64_t k = row.size(); k <= std::min(n, columns_); ++k)
+    {
+      row.emplace_back(k == 0 || k == n ? mp::cpp_int{1} : rows_[n - 1][k - 1] + rows_[n - 1][k]);
+    }
+  }
+
+  void grow(uint64_t n, uint64_t k)
+  {
+    if (k > columns_)
+    {
+      columns_ = std::min(max_columns, std::max(k, 2 * columns_));
+      for (uint64_t row = 1; row < rows_.size(); ++row)
+      {
+        extend_row(row);
+      }
+    }
+    const auto rows = std::min(max_rows, std::max(n + 1, 2 * uint64_t(rows_.size())));
+    while (rows_.size() < rows)
+    {
+      rows_.emplace_back();
+      extend_row(rows_.size() - 1);
+    }
+  }
+
+  static mp::cpp_int direct(uint64_t n, uint64_t k)
+  {
+    // After the step i the value is (n - k + i) over i
+    mp::cpp_int value = 1;
+    for (uint64_t i = 1; i <= k; ++i)
+    {
+      value *= n - k + i;
+      value /= i;
+    }
+    return value;
+  }
+
+public:
+  mp::cpp_int operator()(uint64_t n, uint64_t k)
+  {
+    if (k > n)
+    {
+      return 0;
+    }
+    k = std::min(k, n - k);
+    if (n >= max_rows || k > max_columns)
+    {
+      return direct(n, k);
+    }
+    {
+      std::shared_lock lock(mutex_);
+      if (n < rows_.size() && k < rows_[n].size())
+      {
+        return rows_[n][k];
+      }
+    }
+    std::unique_lock lock(mutex_);
+    grow(n, k);
+    return rows_[n][k];
+  }
+};
+} // namespace
+
+//----------------------------------------------------------------------
+mp::cpp_int
+binomial_coefficient(uint64_t n, uint64_t k)
+{
+  static BinomialCoefficients binomial_coefficients;
+  return binomial_coefficients(n, k);
+}
+
+//----------------------------------------------------------------------
 int64_t
 n_over_k(const int64_t n, const int64_t k)
 {
@@ -17,13 +113,77 @@ n_over_k(const int64_t n, const int64_t k)
         location());
     return (1 - (k & 1) * 2) * n_over_k(-n + k - 1, k);
   }
-  return static_cast<int64_t>(boost::math::binomial_coefficient<double>(
-      static_cast<uint32_t>(n), static_cast<uint32_t>(k)));
+  if (k < 0)
+  {
+    return 0;
+  }
+  const auto value = binomial_coefficient(uint64_t(n), uint64_t(k));
+  ASSERT(
+      value <= std::numeric_limits<int64_t>::max(),
+      "[{}] Binomial coefficient {} over {} exceeds int64_t.",
+      location(),
+      n,
+      k);
+  return static_cast<int64_t>(value);
 }
 
 highp::int_t
 n_over_k(const highp::int_t &n, const highp::int_t &k)
 {
-  return n_over_k(int64_t(n), int64_t(k));
+  if (n < 0)
+  {
+    ASSERT(
+        k >= 0,
+        "[{}] Binomial coefficient not implemented for negative k.",
+        location());
+    const highp::int_t sign = k % 2 == 0 ? 1 : -1;
+    return sign * n_over_k(highp::int_t{-n + k - 1}, k);
+  }
+  if (k < 0 || k > n)
+  {
+    return 0;
+  }
+  ASSERT(
+      n <= highp::int_t{std::numeric_limits<uint64_t>::max()},
+      "[{}] Binomial coefficient over n = {} beyond uint64_t is not implemented.",
+      location(),
+      n.str());
+  const auto value = binomial_coefficient(static_cast<uint64_t>(n), static_cast<uint64_t>(k));
+  ASSERT(
+      value <= mp::cpp_int{std::numeric_limits<highp::int_t>::max()},
+      "[{}] Binomial coefficient {} over {} exceeds highp::int_t.",
+      location(),
+      static_cast<uint64_t>(n),
+      static_cast<uint64_t>(k));
+  return static_cast<highp::int_t>(value);
+}
+
+double
+student_t_95(size_t degrees_of_freedom)
+{
+  ASSERT(degrees_of_freedom > 0, "[{}] Degrees of freedom has to be positive.", location());
+  static constexpr std::array<double, 30> quantiles{
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+      2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+      2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  if (degrees_of_freedom <= quantiles.size())
+  {
+    return quantiles[degrees_of_freedom - 1];
+  }
+  // Between the tabulated points the quantile of the lower bound is taken, so
+  // the interval is never narrower than the exact one.
+  if (degrees_of_freedom <= 40)
+  {
+    return 2.042;
+  }
+  if (degrees_of_freedom <= 60)
+  {
+    return 2.021;
+  }
+  if (degrees_of_freedom <= 120)
+  {
+    return 2.000;
+  }
+  return 1.980;
 }
 } // namespace Math
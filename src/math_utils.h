@@ -68,9 +68,16 @@ product(int64_t from, int64_t to)
   return result;
 }
 
+// Exact binomial coefficient, cached for the small k and shared by the threads.
+mp::cpp_int binomial_coefficient(uint64_t n, uint64_t k);
+
 int64_t      n_over_k(const int64_t n, const int64_t k);
 highp::int_t n_over_k(const highp::int_t &n, const highp::int_t &k);
 
+// Quantile of the Student's t-distribution for the two-sided 95% confidence
+// interval.
+double student_t_95(size_t degrees_of_freedom);
+
 template <typename StrongType>
 StrongType
 n_over_k(const StrongType &n, const StrongType &k)
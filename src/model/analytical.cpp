@@ -7,6 +7,8 @@
 #include "overflow_far.h"
 #include "scenario_settings.h"
 #include "simulation/group.h"
+#include "simulation/source_stream/interrupted_poisson.h"
+#include "simulation/source_stream/poisson.h"
 #include "simulation/source_stream/source_stream.h"
 #include "simulation/source_stream/source_stream_format.h"
 #include "stream_properties_format.h"
@@ -19,12 +21,14 @@
 #include <range/v3/action/transform.hpp>
 #include <range/v3/action/unique.hpp>
 #include <range/v3/algorithm/all_of.hpp>
+#include <range/v3/algorithm/any_of.hpp>
 #include <range/v3/algorithm/none_of.hpp>
 #include <range/v3/to_container.hpp>
 #include <range/v3/view/filter.hpp>
 #include <range/v3/view/map.hpp>
 #include <range/v3/view/transform.hpp>
 #include <range/v3/view/unique.hpp>
+#include <set>
 
 namespace rng = ranges;
 
@@ -474,4 +478,222 @@ determine_layers_types(const Simulation::Topology &topology)
   }
   return layers_types;
 }
+
+//----------------------------------------------------------------------
+// Mean occupancy of the groups which the Kaufman-Roberts distribution
+// describes exactly: a single bucket without compression and blocked traffic
+// classes, offered only the Poisson sources and no overflowed traffic. Empty if
+// the analytical model cannot be applied to the topology.
+std::map<GroupName, double>
+primary_groups_mean_occupancy(const Simulation::Topology &topology)
+{
+  std::map<GroupName, double> mean_occupancy;
+  if (rng::any_of(
+          determine_layers_types(topology) | rng::views::values,
+          [](auto layer_type) { return layer_type == LayerType::Unknown; }))
+  {
+    return mean_occupancy;
+  }
+
+  std::set<GroupName> overflow_targets;
+  for (const auto &[group_name, group] : topology.groups)
+  {
+    std::ignore = group_name;
+    for (const auto &next_group : group->next_groups())
+    {
+      overflow_targets.insert(next_group->name());
+    }
+  }
+
+  for (const auto &[group_name, group] : topology.groups)
+  {
+    if (overflow_targets.count(group_name) > 0 || group->capacity().size() != 1
+        || !group->tcs_compression_.empty() || !group->tcs_block_.empty())
+    {
+      continue;
+    }
+    IncomingRequestStreams in_request_streams;
+    bool                   poisson_only = true;
+    for (const auto &[source_name, source_stream] : topology.sources)
+    {
+      std::ignore = source_name;
+      if (source_stream->get_target_group().name() != group_name)
+      {
+        continue;
+      }
+      poisson_only = poisson_only
+                     && dynamic_cast<const Simulation::PoissonSourceStream *>(
+                            source_stream.get())
+                            != nullptr;
+      in_request_streams.emplace_back(source_stream->tc_);
+    }
+    if (!poisson_only || in_request_streams.empty())
+    {
+      continue;
+    }
+
+    const auto distribution = kaufman_roberts_distribution(
+        in_request_streams,
+        Resource<CapacityF>(Resource<>(to_model(group->capacity()))),
+        Size{0},
+        KaufmanRobertsVariant::FixedCapacity);
+    double mean = 0.0;
+    for (size_t n = 0; n < distribution.size(); ++n)
+    {
+      mean += static_cast<double>(n) * static_cast<double>(get(distribution[n]));
+    }
+    mean_occupancy.emplace(group_name, mean);
+  }
+  return mean_occupancy;
+}
+
+//----------------------------------------------------------------------
+// Synthetic source of the overflow stream of a traffic class. The interrupted
+// Poisson process is fitted to the mean R and the peakedness Z of the stream.
+// In the on phase the requests arrive with the intensity lambda offered to the
+// group, as they overflow while the group is full. For the infinite
+// group Z = 1 + (lambda - R mu) / (s + mu), which gives the sum s of the
+// switching intensities of the phases. If lambda is too low for that, the
+// switching intensity equal to the service intensity is used and lambda is
+// fitted instead. A stream which is not peaked is offered as the Poisson one.
+// Empty if nothing overflows.
+static std::unique_ptr<Simulation::SourceStream>
+make_overflow_stream(const SourceName &name, const OutgoingRequestStream &out_stream)
+{
+  const auto mean = static_cast<long double>(get(out_stream.mean));
+  const auto peakedness = static_cast<long double>(get(out_stream.peakedness));
+  const auto mu = ts::get(out_stream.tc.serve_intensity);
+  if (mean <= 0.0L)
+  {
+    return {};
+  }
+
+  auto tc = out_stream.tc;
+  tc.source_intensity = Simulation::Intensity{mean * mu};
+  if (peakedness <= 1.0L)
+  {
+    return std::make_unique<Simulation::PoissonSourceStream>(name, tc);
+  }
+  auto on_intensity = static_cast<long double>(get(out_stream.intensity)) * mu;
+  auto switching = (on_intensity - mean * mu) / (peakedness - 1.0L) - mu;
+  if (switching <= 0.0L)
+  {
+    switching = mu;
+    on_intensity = mean * mu + (peakedness - 1.0L) * (switching + mu);
+  }
+  const auto off_to_on = mean * mu * switching / on_intensity;
+  return std::make_unique<Simulation::InterruptedPoissonSourceStream>(
+      name,
+      tc,
+      Simulation::Intensity{on_intensity},
+      Simulation::Intensity{switching - off_to_on},
+      Simulation::Intensity{off_to_on});
+}
+
+//----------------------------------------------------------------------
+// Hybrid simulation: the groups of the given layers are computed with the
+// analytical model and removed from the topology together with their sources.
+// The traffic they overflow to the simulated groups is offered by the
+// synthetic sources, see make_overflow_stream().
+void
+replace_layers_with_overflow_streams(
+    Simulation::Topology     &topology,
+    const std::vector<Layer> &layers,
+    KaufmanRobertsVariant     kr_variant)
+{
+  const auto is_replaced = [&](Simulation::Group &group) {
+    return rng::any_of(layers, [&](auto layer) { return layer == group.layer(); });
+  };
+  for (const auto &layer : layers)
+  {
+    ASSERT(
+        topology.groups_per_layer.count(layer) > 0,
+        "[{}] There are no groups in the layer {}.",
+        location(),
+        layer);
+    ASSERT(
+        check_layer_type(topology, layer) == LayerType::FullAvailability,
+        "[{}] Only the layers of full availability groups can be replaced, layer {}.",
+        location(),
+        layer);
+  }
+
+  std::map<GroupName, Model::Group>                 model_groups;
+  std::map<Layer, std::vector<Simulation::Group *>> replaced_groups;
+  for (auto &[group_name, group] : topology.groups)
+  {
+    if (!is_replaced(*group))
+    {
+      for (auto *next_group : group->next_groups())
+      {
+        ASSERT(
+            !is_replaced(*next_group),
+            "[{}] Group '{}' overflows to the replaced group '{}'.",
+            location(),
+            group_name,
+            next_group->name());
+      }
+      continue;
+    }
+    model_groups.emplace(group_name, Model::Group{to_model(group->capacity()), kr_variant});
+    replaced_groups[group->layer()].emplace_back(group.get());
+  }
+
+  std::vector<SourceName> replaced_sources;
+  for (const auto &[source_name, source_stream] : topology.sources)
+  {
+    auto it = model_groups.find(source_stream->get_target_group().name());
+    if (it != end(model_groups))
+    {
+      it->second.add_incoming_request_stream(IncomingRequestStream{source_stream->tc_});
+      replaced_sources.emplace_back(source_name);
+    }
+  }
+  for (const auto &source_name : replaced_sources)
+  {
+    topology.sources.erase(source_name);
+  }
+
+  for (const auto &[layer, groups] : replaced_groups)
+  {
+    for (auto *group : groups)
+    {
+      const auto &out_streams = model_groups.at(group->name()).get_outgoing_request_streams();
+      for (auto *next_group : group->next_groups())
+      {
+        if (is_replaced(*next_group))
+        {
+          ASSERT(
+              next_group->layer() > layer,
+              "[{}] Group '{}' overflows to the replaced group '{}' of the same or lower layer.",
+              location(),
+              group->name(),
+              next_group->name());
+          model_groups.at(next_group->name()).add_incoming_request_streams(out_streams);
+          continue;
+        }
+        for (const auto &out_stream : out_streams)
+        {
+          SourceName name{
+              fmt::format("{}>{}:{}", group->name(), next_group->name(), out_stream.tc.id)};
+          if (auto source = make_overflow_stream(name, out_stream))
+          {
+            debug_println("[Analytical] Overflow stream '{}': {}", name, out_stream);
+            topology.add_source(std::move(source)).attach_to_group(*next_group);
+          }
+        }
+      }
+    }
+  }
+
+  for (const auto &[layer, groups] : replaced_groups)
+  {
+    topology.groups_per_layer.erase(layer);
+    for (auto *group : groups)
+    {
+      const auto group_name = group->name();
+      topology.groups.erase(group_name);
+    }
+  }
+}
 } // namespace Model
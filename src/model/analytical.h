@@ -5,6 +5,8 @@
 #include "types/types.h"
 
 #include <boost/container/flat_map.hpp>
+#include <map>
+#include <vector>
 
 struct ScenarioSettings;
 
@@ -26,4 +28,12 @@ bool      check_model_prerequisites(const ScenarioSettings &scenario_settings);
 boost::container::flat_map<Layer, LayerType>
 determine_layers_types(const Simulation::Topology &topology);
 
+std::map<GroupName, double>
+primary_groups_mean_occupancy(const Simulation::Topology &topology);
+
+void replace_layers_with_overflow_streams(
+    Simulation::Topology     &topology,
+    const std::vector<Layer> &layers,
+    KaufmanRobertsVariant     kr_variant);
+
 } // namespace Model
@@ -9,9 +9,15 @@
 #include "types/difference_type.h"
 #include "types/types_format.h"
 
+#include <cmath>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <tuple>
 #include <range/v3/algorithm/for_each.hpp>
 #include <range/v3/algorithm/transform.hpp>
 #include <range/v3/numeric/accumulate.hpp>
@@ -116,79 +122,221 @@ compute_fictitious_capacity_fit_carried_traffic(
 }
 //----------------------------------------------------------------------
 
-Probabilities
-kaufman_roberts_distribution(
+// Conditional transition probability of a state outside of the table of the
+// resource, see transition_probabilities().
+static Probability
+transition_probability(const Capacity n, const Resource<CapacityF> &resource, const Size t)
+{
+  if (resource.components.size() == 1)
+  {
+    // NOTE(PW): distributed equal components
+    return conditional_transition_probability(n, resource.components.front(), t);
+  }
+  else
+  {
+    // NOTE(PW): distributed unequal components
+    return conditional_transition_probability(n, resource, t);
+  }
+}
+
+//----------------------------------------------------------------------
+// Unnormalized states 0..V_max of the Kaufman-Roberts recursion. The states do
+// not depend on the capacity of the resource, so the distributions for all the
+// offsets are the normalized prefixes of a single pass.
+//
+// All the terms are non-negative, so in the long double arithmetic only the
+// range of the exponent is a problem. The states are rescaled whenever the
+// current one exceeds the limit, the early states then underflow to zero,
+// which is below the precision of the distribution as long as no later state
+// is computed from them. A state is reached if it is not zero in the exact
+// arithmetic. Empty if a reached state underflows, either when it is computed
+// or when the recursion reads it, or if a state is not a finite non-negative
+// number, the high precision pass is required then.
+template <typename T>
+static std::optional<std::vector<T>>
+kaufman_roberts_states(
     const IncomingRequestStreams &in_request_streams,
-    const Resource<CapacityF>     resource,
-    const Size                    offset,
+    const Resource<CapacityF>    &resource,
+    const Capacity                V_max,
     const KaufmanRobertsVariant   kr_variant)
 {
-  const auto    V = Model::Capacity{resource.V()} + offset;
-  Probabilities state(size_t(V) + 1, Probability{0});
-  state[0] = Probability{1};
+  constexpr long double rescale_limit = 1e100L;
 
-  for (Capacity n{1}; n <= V; ++n)
+  std::vector<SizeF> tc_sizes;
+  std::vector<T>     weights;
+  for (const auto &rs : in_request_streams)
   {
-    for (const auto &rs : in_request_streams)
+    const auto &tc_size = tc_sizes.emplace_back([&]() -> SizeF {
+      if (kr_variant == KaufmanRobertsVariant::FixedReqSize)
+      {
+        return SizeF{rs.tc.size};
+      }
+      else
+      {
+        return SizeRescale{rs.peakedness} * Size{rs.tc.size};
+      }
+    }());
+    weights.emplace_back(static_cast<T>(highp::float_t{get(rs.intensity) * get(tc_size)}));
+  }
+  // Single component means full availability group
+  const bool full_availability =
+      resource.components.size() == 1 && resource.components.front().number <= Count{1};
+
+  // The tables are shared by the streams of equal size, see
+  // transition_probabilities().
+  std::vector<std::vector<T>> chis(tc_sizes.size());
+  if (!full_availability)
+  {
+    for (size_t i = 0; i < tc_sizes.size(); ++i)
     {
-      const SizeF tc_size = [&]() -> SizeF {
-        if (kr_variant == KaufmanRobertsVariant::FixedReqSize)
-        {
-          return SizeF{rs.tc.size};
-        }
-        else
-        {
-          return SizeRescale{rs.peakedness} * Size{rs.tc.size};
-        }
-      }();
-      const auto previous_state = Capacity{CapacityF{n} - tc_size};
-      if (previous_state >= Capacity{0})
+      const auto table = transition_probabilities(resource, Size(tc_sizes[i]));
+      chis[i].reserve(table->size());
+      for (const auto &chi : *table)
       {
-        Probability previous_state_value{0};
+        chis[i].emplace_back(static_cast<T>(get(chi)));
+      }
+    }
+  }
 
-        if (auto prec = get(CapacityF{n} - tc_size);
-            (false) && floor(prec) < prec)
-        {
-          const auto fraction = prec - floor(prec);
-          const auto s1 = state[size_t(previous_state)];
-          const auto s2 =
-              state[std::min(size_t(previous_state) + 1, size_t(V))];
-          previous_state_value =
-              Probability{Math::lerp(1 - fraction, get(s1), get(s2))};
-        }
-        else
+  std::vector<T> state(size_t(V_max) + 1, T{0});
+  state[0] = T{1};
+  std::vector<bool> reached(size_t(V_max) + 1, false);
+  reached[0] = true;
+
+  for (Capacity n{1}; n <= V_max; ++n)
+  {
+    auto &current = state[size_t(n)];
+    for (size_t i = 0; i < tc_sizes.size(); ++i)
+    {
+      const auto &tc_size = tc_sizes[i];
+      const auto  previous_state = Capacity{CapacityF{n} - tc_size};
+      if (previous_state < Capacity{0})
+      {
+        continue;
+      }
+      const auto chi = full_availability ? T{1}
+                       : size_t(previous_state) < chis[i].size()
+                           ? chis[i][size_t(previous_state)]
+                           : static_cast<T>(get(transition_probability(
+                               previous_state, resource, Size(tc_size))));
+      const auto &previous = state[size_t(previous_state)];
+      if constexpr (std::is_floating_point_v<T>)
+      {
+        if (reached[size_t(previous_state)] && weights[i] > T{0} && chi > T{0})
         {
-          previous_state_value = state[size_t(previous_state)];
-        }
-        const auto chi = [&]() -> Probability {
-          if (resource.components.size() == 1)
+          if (previous < std::numeric_limits<T>::min())
           {
-            // NOTE(PW): distributed equal components
-            const ResourceComponent<CapacityF> &component =
-                resource.components.front();
-            return component.number > Count{1}
-                       ? conditional_transition_probability(
-                           previous_state, component, Size(tc_size))
-                       : Probability{1};
+            return {};
           }
-          else
-          {
-            // NOTE(PW): distributed unequal components
-            return conditional_transition_probability(
-                previous_state, resource, Size(tc_size));
-          }
-        }();
-        ASSERT(!isnan(get(chi)), "[{}] Chi shouldn't be nan.", location());
+          reached[size_t(n)] = true;
+        }
+      }
 
-        state[size_t(n)] += rs.intensity * tc_size * chi * previous_state_value;
+      current += weights[i] * chi * previous;
+    }
+    current /= static_cast<T>(size_t(n));
+
+    if constexpr (std::is_floating_point_v<T>)
+    {
+      if (!std::isfinite(current) || current < T{0}
+          || (reached[size_t(n)] && current < std::numeric_limits<T>::min()))
+      {
+        return {};
+      }
+      if (current > rescale_limit)
+      {
+        const auto scale = current;
+        for (size_t i = 0; i <= size_t(n); ++i)
+        {
+          state[i] /= scale;
+        }
       }
     }
-    state[size_t(n)] /= n;
   }
-  Math::normalize_L1(state);
   return state;
 }
 
+//----------------------------------------------------------------------
+template <typename T>
+static Probabilities
+normalized_prefix(const std::vector<T> &state, const Capacity V)
+{
+  Probabilities distribution;
+  distribution.reserve(size_t(V) + 1);
+  for (size_t n = 0; n <= size_t(V); ++n)
+  {
+    distribution.emplace_back(highp::float_t{state[n]});
+  }
+  Math::normalize_L1(distribution);
+  return distribution;
+}
+
+//----------------------------------------------------------------------
+// Passes the states 0..V_max to the function. The recursion runs in long
+// double and falls back to the high precision only if it is not stable.
+template <typename F>
+static void
+with_kaufman_roberts_states(
+    const IncomingRequestStreams &in_request_streams,
+    const Resource<CapacityF>    &resource,
+    const Capacity                V_max,
+    const KaufmanRobertsVariant   kr_variant,
+    F                           &&use_states)
+{
+  if (auto state =
+          kaufman_roberts_states<long double>(in_request_streams, resource, V_max, kr_variant))
+  {
+    use_states(*state);
+    return;
+  }
+  debug_println(
+      "[KaufmanRoberts] Unstable in long double, V_max: {}, using high precision", V_max);
+  use_states(
+      *kaufman_roberts_states<highp::float_t>(in_request_streams, resource, V_max, kr_variant));
+}
+
+//----------------------------------------------------------------------
+// Distributions of the occupancy of the resource extended by 0..max_offset
+// allocation units.
+std::vector<Probabilities>
+kaufman_roberts_distributions(
+    const IncomingRequestStreams &in_request_streams,
+    const Resource<CapacityF>     resource,
+    const Size                    max_offset,
+    const KaufmanRobertsVariant   kr_variant)
+{
+  const auto V = Model::Capacity{resource.V()};
+  const auto V_max = V + max_offset;
+
+  std::vector<Probabilities> distributions;
+  with_kaufman_roberts_states(
+      in_request_streams, resource, V_max, kr_variant, [&](const auto &state) {
+        for (Capacity V_offset = V; V_offset <= V_max; ++V_offset)
+        {
+          distributions.emplace_back(normalized_prefix(state, V_offset));
+        }
+      });
+  return distributions;
+}
+
+//----------------------------------------------------------------------
+Probabilities
+kaufman_roberts_distribution(
+    const IncomingRequestStreams &in_request_streams,
+    const Resource<CapacityF>     resource,
+    const Size                    offset,
+    const KaufmanRobertsVariant   kr_variant)
+{
+  const auto V = Model::Capacity{resource.V()} + offset;
+
+  Probabilities distribution;
+  with_kaufman_roberts_states(
+      in_request_streams, resource, V, kr_variant, [&](const auto &state) {
+        distribution = normalized_prefix(state, V);
+      });
+  return distribution;
+}
+
 //----------------------------------------------------------------------
 OutgoingRequestStreams
 kaufman_roberts_blocking_probability(
@@ -198,10 +346,10 @@ kaufman_roberts_blocking_probability(
 {
   CapacityF V = resource.V();
   debug_println("V: {}, Resource: {}", V, resource);
-  auto distribution = kaufman_roberts_distribution(
-      in_request_streams, resource, Size{0}, kr_variant);
-  auto distribution2 = kaufman_roberts_distribution(
-      in_request_streams, resource, Size{1}, kr_variant);
+  const auto distributions =
+      kaufman_roberts_distributions(in_request_streams, resource, Size{1}, kr_variant);
+  const auto &distribution = distributions[0];
+  const auto &distribution2 = distributions[1];
   debug_println("Distribution: {}", distribution);
   std::vector<OutgoingRequestStream> out_request_streams;
   for (const auto &in_rs : in_request_streams)
@@ -403,6 +551,41 @@ struct NCounter
   bool        finished() const { return finished_; }
 };
 
+//----------------------------------------------------------------------
+// Numbers of the arrangements of x = 0..x_max free allocation units in the
+// components of the resource, i.e. the coefficients of the product of
+// (1 + z + ... + z^f_s)^v_s over the types of the components. Each component
+// multiplies the polynomial by (1 + z + ... + z^f), which is a sliding window
+// sum of f + 1 coefficients, so all x take O(x_max) per component. Exact for any
+// size of the resource.
+template <typename C>
+static std::vector<mp::cpp_int>
+arrangement_numbers(const Resource<C> &resource, const Capacity x_max)
+{
+  std::vector<mp::cpp_int> numbers(size_t(x_max) + 1, 0);
+  numbers[0] = 1;
+  std::vector<mp::cpp_int> next(numbers.size(), 0);
+  for (const auto &component : resource.components)
+  {
+    const auto f = size_t(Capacity(component.v));
+    for (Count i{0}; i < component.number; ++i)
+    {
+      mp::cpp_int window = 0;
+      for (size_t x = 0; x < numbers.size(); ++x)
+      {
+        window += numbers[x];
+        if (x > f)
+        {
+          window -= numbers[x - f - 1];
+        }
+        next[x] = window;
+      }
+      std::swap(numbers, next);
+    }
+  }
+  return numbers;
+}
+
 //----------------------------------------------------------------------
 // Formula 3.38
 template <typename C>
@@ -410,6 +593,32 @@ Count
 combinatorial_arrangement_number_unequal_resources(
     const Capacity    x, // number of free allocation units
     const Resource<C> resource)
+{
+  if (x < Capacity{0})
+  {
+    return Count{0};
+  }
+  const auto number = arrangement_numbers(resource, x)[size_t(x)];
+  ASSERT(
+      number <= mp::cpp_int{std::numeric_limits<Count::value_type>::max()},
+      "[{}] Arrangement number of {} free allocation units exceeds Count.",
+      location(),
+      x);
+  return Count{static_cast<Count::value_type>(number)};
+}
+
+template Count combinatorial_arrangement_number_unequal_resources<Capacity>(
+    const Capacity           x, // number of free allocation units
+    const Resource<Capacity> resource);
+
+//----------------------------------------------------------------------
+// Formula 3.38 by enumerating all the divisions of x between the types of the
+// components, kept for validation.
+template <typename C>
+Count
+combinatorial_arrangement_number_unequal_resources_reference(
+    const Capacity    x, // number of free allocation units
+    const Resource<C> resource)
 {
   debug_println<DebugTransition>("x: {}", x);
   const auto component_types_number =
@@ -443,7 +652,7 @@ combinatorial_arrangement_number_unequal_resources(
   return sum;
 }
 
-template Count combinatorial_arrangement_number_unequal_resources<Capacity>(
+template Count combinatorial_arrangement_number_unequal_resources_reference<Capacity>(
     const Capacity           x, // number of free allocation units
     const Resource<Capacity> resource);
 
@@ -480,7 +689,8 @@ conditional_transition_probability(
   return Probability{1} - Probability{nominator / denominator};
 }
 //----------------------------------------------------------------------
-// Formula (3.37)
+// Formula (3.37). The states of the resource are taken from the table shared
+// by all of them, see transition_probabilities().
 template <typename C>
 Probability
 conditional_transition_probability(
@@ -490,10 +700,10 @@ conditional_transition_probability(
 {
   auto V = Capacity{resource.V()};
   debug_println<DebugTransition>("OrigV: {}, V: {}", resource.V(), V);
-  // if (n == V)
-  // {
-  // return Probability{0};
-  // }
+  if (n >= Capacity{0} && n <= V)
+  {
+    return (*transition_probabilities(Resource<CapacityF>(resource), t))[size_t(n)];
+  }
   const auto denominator =
       combinatorial_arrangement_number_unequal_resources(V - n, resource);
   if (denominator == Count{0})
@@ -519,4 +729,81 @@ conditional_transition_probability(
   return Probability{1} - Probability{nominator / denominator};
 }
 
+//----------------------------------------------------------------------
+// Formulas (3.34) and (3.37) for all the states at once.
+static TransitionProbabilities
+compute_transition_probabilities(const Resource<CapacityF> &resource, const Size t)
+{
+  const auto V = Capacity{resource.V()};
+  const auto states = size_t(V) + 1;
+
+  auto nominator_resource = resource;
+  for (auto &component : nominator_resource.components)
+  {
+    component.v = CapacityF{Capacity{t - Size{1}}};
+  }
+  const auto nominators = arrangement_numbers(nominator_resource, V);
+  const auto denominators = arrangement_numbers(resource, V);
+  const bool equal_components = resource.components.size() == 1;
+
+  TransitionProbabilities table;
+  table.reserve(states);
+  for (size_t n = 0; n < states; ++n)
+  {
+    const auto x = states - 1 - n;
+    if (nominators[x] == 0 || (!equal_components && denominators[x] == 0))
+    {
+      table.emplace_back(Probability{1});
+      continue;
+    }
+    ASSERT(denominators[x] != 0, "[{}] Denominator cannot be zero.", location());
+    const auto nominator = static_cast<highp::float_t>(nominators[x]);
+    const auto denominator = static_cast<highp::float_t>(denominators[x]);
+    table.emplace_back(Probability{highp::float_t{1 - nominator / denominator}});
+  }
+  return table;
+}
+
+//----------------------------------------------------------------------
+// The tables depend only on the capacities of the components (as the integer
+// numbers of allocation units) and on the request size. The Model::Group
+// objects of every point of a sweep are distinct, so the tables are cached by
+// the resource and shared by all the groups and threads.
+//
+// The resources of a sweep repeat, but the fictitious ones of the overflow
+// groups may differ at every point, so the cache is emptied when it holds
+// max_tables tables. The tables still in use are kept alive by their owners.
+std::shared_ptr<const TransitionProbabilities>
+transition_probabilities(const Resource<CapacityF> &resource, const Size t)
+{
+  ASSERT(t >= Size{1}, "[{}] Request size has to be positive, but is {}.", location(), t);
+  using Key = std::tuple<std::vector<std::pair<int64_t, int64_t>>, int64_t, int64_t>;
+  constexpr size_t                                                     max_tables = 256;
+  static std::shared_mutex                                             mutex;
+  static std::map<Key, std::shared_ptr<const TransitionProbabilities>> tables;
+
+  Key key{{}, static_cast<int64_t>(get(Capacity{resource.V()})), static_cast<int64_t>(get(t))};
+  for (const auto &component : resource.components)
+  {
+    std::get<0>(key).emplace_back(
+        static_cast<int64_t>(get(component.number)),
+        static_cast<int64_t>(get(Capacity(component.v))));
+  }
+  {
+    std::shared_lock lock(mutex);
+    if (auto it = tables.find(key); it != end(tables))
+    {
+      return it->second;
+    }
+  }
+  auto table = std::make_shared<const TransitionProbabilities>(
+      compute_transition_probabilities(resource, t));
+  std::unique_lock lock(mutex);
+  if (tables.size() >= max_tables)
+  {
+    tables.clear();
+  }
+  return tables.try_emplace(std::move(key), std::move(table)).first->second;
+}
+
 } // namespace Model
@@ -7,6 +7,7 @@
 #include "traffic_class.h"
 #include "types/types.h"
 
+#include <memory>
 #include <valarray>
 #include <vector>
 
@@ -19,6 +20,12 @@ Probabilities kaufman_roberts_distribution(
     Size                          offset,
     KaufmanRobertsVariant         kr_variant);
 
+std::vector<Probabilities> kaufman_roberts_distributions(
+    const IncomingRequestStreams &in_request_streams,
+    Resource<CapacityF>           resource,
+    Size                          max_offset,
+    KaufmanRobertsVariant         kr_variant);
+
 OutgoingRequestStreams kaufman_roberts_blocking_probability(
     const IncomingRequestStreams &in_request_streams,
     Resource<CapacityF>           resource,
@@ -56,6 +63,16 @@ conditional_transition_probability(Capacity n, const ResourceComponent<C> &compo
 template <typename C>
 Count combinatorial_arrangement_number_unequal_resources(Capacity x, Resource<C> resource);
 template <typename C>
+Count
+combinatorial_arrangement_number_unequal_resources_reference(Capacity x, Resource<C> resource);
+template <typename C>
 Probability conditional_transition_probability(Capacity n, const Resource<C> &resource, Size t);
 
+// Conditional transition probabilities of the states n = 0..V of the resource
+// for the requests of the size t.
+using TransitionProbabilities = std::vector<Probability>;
+
+std::shared_ptr<const TransitionProbabilities>
+transition_probabilities(const Resource<CapacityF> &resource, Size t);
+
 } // namespace Model
@@ -18,6 +18,7 @@
 #include "utils.h"
 
 #include <boost/program_options/parsers.hpp>
+#include <chrono>
 #include <fmt/format.h>
 #include <fmt/ranges.h>
 #include <fstream>
@@ -28,6 +29,12 @@
 #include <range/v3/utility/functional.hpp>
 #include <range/v3/view/map.hpp>
 #include <sys/ioctl.h>
+#include <unordered_map>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace rng = ranges;
 
@@ -65,6 +72,44 @@ print_state(const std::vector<bool> &states)
 }
 
 //----------------------------------------------------------------------
+int
+max_threads_number()
+{
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+int
+thread_number()
+{
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+void
+print_threads_usage(
+    const std::vector<ThreadUsage> &threads_usage,
+    std::chrono::duration<double>   wall_time)
+{
+  for (auto thread = 0ul; thread < threads_usage.size(); ++thread)
+  {
+    const auto &usage = threads_usage[thread];
+    println(
+        "[Main]: Thread {:>2}: {} scenarios, busy {:.2f}/{:.2f} s ({:.0f}%)",
+        thread,
+        usage.scenarios,
+        usage.busy_time.count(),
+        wall_time.count(),
+        100.0 * usage.busy_time.count() / wall_time.count());
+  }
+}
+
 //----------------------------------------------------------------------
 nlohmann::json
 run_scenarios(std::vector<ScenarioSettings> &scenarios, const CLIOptions &cli)
@@ -74,15 +119,51 @@ run_scenarios(std::vector<ScenarioSettings> &scenarios, const CLIOptions &cli)
 
   print_state(scenarios_state);
 
-  sort(begin(scenarios), end(scenarios), [](const auto &s1, const auto &s2) {
-    return s1.a > s2.a;
+  // In the coupled sweep all the load points of a scenario file share the
+  // random streams, the replications still have their own. The points are
+  // still simulated separately, the coupling only reduces the variance of the
+  // differences between them.
+  std::unordered_map<std::string, size_t> first_of_file;
+  for (auto i = 0ul; i < scenarios.size(); ++i)
+  {
+    scenarios[i].index = i;
+    scenarios[i].stream_index =
+        cli.coupled_sweep ? first_of_file.try_emplace(scenarios[i].filename, i).first->second : i;
+  }
+
+  // The most expensive scenarios are started first and each idle thread takes
+  // the next one, so the cheap ones fill the gaps at the end of the sweep.
+  std::vector<std::pair<double, size_t>> costs;
+  costs.reserve(scenarios.size());
+  for (auto i = 0ul; i < scenarios.size(); ++i)
+  {
+    costs.emplace_back(estimate_cost(scenarios[i], cli), i);
+  }
+  sort(begin(costs), end(costs), [&scenarios](const auto &c1, const auto &c2) {
+    if (c1.first != c2.first)
+    {
+      return c1.first > c2.first;
+    }
+    return scenarios[c1.second].a > scenarios[c2.second].a;
   });
+  std::vector<ScenarioSettings> sorted_scenarios;
+  sorted_scenarios.reserve(scenarios.size());
+  for (const auto &[cost, index] : costs)
+  {
+    std::ignore = cost;
+    sorted_scenarios.emplace_back(std::move(scenarios[index]));
+  }
+  scenarios = std::move(sorted_scenarios);
+
+  std::vector<ThreadUsage> threads_usage(static_cast<size_t>(max_threads_number()));
+  const auto               start = std::chrono::steady_clock::now();
 
 #if !SINGLE_THREADED
-#pragma omp parallel for schedule(guided, 8) if (cli.parallel)
+#pragma omp parallel for schedule(dynamic, 1) if (cli.parallel)
 #endif
   for (auto i = 0ul; i < scenarios.size(); ++i)
   {
+    const auto scenario_start = std::chrono::steady_clock::now();
     debug_println(
         fg(fmt::color::green),
         "Scenario: {}, file: {}",
@@ -93,7 +174,7 @@ run_scenarios(std::vector<ScenarioSettings> &scenarios, const CLIOptions &cli)
     {
       case Mode::Simulation:
       {
-        run_scenario(scenarios[i], cli.duration, cli.use_random_seed, true);
+        run_scenario(scenarios[i], cli, true);
         break;
       }
       case Mode::Analytic:
@@ -107,24 +188,39 @@ run_scenarios(std::vector<ScenarioSettings> &scenarios, const CLIOptions &cli)
       }
     }
 
-    auto A_str = std::to_string(ts::get(scenarios[i].A));
-    auto filename = scenarios[i].filename;
 #if !SINGLE_THREADED
 #pragma omp critical
 #endif
     {
-      if (global_stats.find(filename) == end(global_stats))
-      {
-        global_stats[filename]["_scenario"] = scenarios[i].json;
-      }
-      auto &scenario_stats = global_stats[filename][A_str];
-      scenario_stats = concatenate(scenario_stats, scenarios[i].stats);
-      scenario_stats["_a"] = ts::get(scenarios[i].a);
-      scenario_stats["_A"] = ts::get(scenarios[i].A);
-
       scenarios_state[i] = true;
       print_state(scenarios_state);
     }
+
+    auto &thread_usage = threads_usage[static_cast<size_t>(thread_number())];
+    thread_usage.busy_time += std::chrono::steady_clock::now() - scenario_start;
+    thread_usage.scenarios++;
+  }
+  print_threads_usage(threads_usage, std::chrono::steady_clock::now() - start);
+
+  // The stats are merged in the order in which the scenarios were loaded, not
+  // in which they finished, so the output does not depend on the threads.
+  std::vector<const ScenarioSettings *> loaded_scenarios(scenarios.size());
+  for (const auto &scenario : scenarios)
+  {
+    loaded_scenarios[scenario.index] = &scenario;
+  }
+  for (const auto *scenario : loaded_scenarios)
+  {
+    auto A_str = std::to_string(ts::get(scenario->A));
+    auto filename = scenario->filename;
+    if (global_stats.find(filename) == end(global_stats))
+    {
+      global_stats[filename]["_scenario"] = scenario->json;
+    }
+    auto &scenario_stats = global_stats[filename][A_str];
+    scenario_stats = concatenate(scenario_stats, scenario->stats);
+    scenario_stats["_a"] = ts::get(scenario->a);
+    scenario_stats["_A"] = ts::get(scenario->A);
   }
   return global_stats;
 }
@@ -170,6 +266,11 @@ load_scenarios_from_files(
     const auto [topology, topology_json] =
         Config::parse_topology_config(scenario_file, cli.append_scenario_files);
     // Config::dump(topology);
+    auto A_max = cli.A_start;
+    for (auto A = cli.A_start; A < cli.A_stop; A += cli.A_step)
+    {
+      A_max = A;
+    }
     for (auto A = cli.A_start; A < cli.A_stop; A += cli.A_step)
     {
       if (contains(cli.modes, Mode::Simulation))
@@ -180,6 +281,11 @@ load_scenarios_from_files(
           auto scenario = prepare_scenario_local_group_A(topology, A);
           scenario.name += fmt::format(" A={}", A);
           scenario.mode = Mode::Simulation;
+          scenario.replication = i;
+          if (cli.coupled_sweep)
+          {
+            scenario.thinning = static_cast<double>(ts::get(A) / ts::get(A_max));
+          }
 
           std::string filename = scenario_file;
           auto &      appended_filenames = cli.append_scenario_files;
@@ -189,6 +295,18 @@ load_scenarios_from_files(
                 "{};{}", scenario_file, join(appended_filenames, ";"));
           }
           scenario.filename = filename;
+          if (!cli.hybrid_layers.empty())
+          {
+            const auto kr_variant =
+                !cli.analytic_models.empty()
+                        && cli.analytic_models.front()
+                               == Model::AnalyticModel::KaufmanRobertsFixedCapacity
+                    ? Model::KaufmanRobertsVariant::FixedCapacity
+                    : Model::KaufmanRobertsVariant::FixedReqSize;
+            Model::replace_layers_with_overflow_streams(
+                scenario.topology, cli.hybrid_layers, kr_variant);
+            scenario.filename = fmt::format("{};hybrid", filename);
+          }
           scenario.json = topology_json;
           scenarios.emplace_back(std::move(scenario));
         }
@@ -4,6 +4,7 @@
 #include "config.h"
 #include "scenario_settings.h"
 
+#include <chrono>
 #include <filesystem>
 #include <nlohmann/json.hpp>
 #include <string>
@@ -13,9 +14,21 @@ struct CLIOptions;
 
 namespace fs = std::filesystem;
 
+struct ThreadUsage
+{
+  std::chrono::duration<double> busy_time{};
+  int                           scenarios = 0;
+};
+
 void           print_state(const std::vector<bool> &states);
 nlohmann::json run_scenarios(std::vector<ScenarioSettings> &scenarios, const CLIOptions &cli);
 
+int  max_threads_number();
+int  thread_number();
+void print_threads_usage(
+    const std::vector<ThreadUsage> &threads_usage,
+    std::chrono::duration<double>   wall_time);
+
 void load_scenarios_from_files(
     std::vector<ScenarioSettings> & scenarios,
     const std::vector<std::string> &scenario_files,
@@ -1,37 +1,53 @@
 
 #include "scenario_settings.h"
 
+#include "model/analytical.h"
 #include "simulation/group.h"
+#include "simulation/random.h"
+#include "simulation/source_stream/poisson.h"
 #include "simulation/source_stream/source_stream.h"
 #include "simulation/world.h"
 #include "utils.h"
 
-#include <random>
-
-uint64_t
-seed(bool use_random_seed)
-{
-  if (!use_random_seed)
-  {
-    return 0;
-  }
-  std::random_device rd;
-  return rd();
-}
+#include <algorithm>
+#include <cmath>
 
 void
-run_scenario(ScenarioSettings &scenario, const Duration duration, bool use_random_seed, bool quiet)
+run_scenario(ScenarioSettings &scenario, const CLIOptions &cli, bool quiet)
 {
-  scenario.world = std::make_unique<Simulation::World>(seed(use_random_seed), duration);
+  const auto key = Simulation::replication_key(
+      cli.seed,
+      scenario.stream_index,
+      static_cast<uint64_t>(scenario.replication));
+  scenario.world = std::make_unique<Simulation::World>(
+      key, cli.duration, cli.event_set, cli.exponential);
   auto &world = *scenario.world;
   world.set_topology(scenario.topology);
+  if (cli.coupled_sweep)
+  {
+    for (auto &[name, source] : scenario.topology.sources)
+    {
+      std::ignore = name;
+      source->set_thinning(scenario.thinning);
+    }
+  }
+  world.set_epochs(cli.epochs);
+  world.set_warmup_detection(cli.warmup_detection);
+  world.set_stop_condition(cli.stop_condition);
+  world.set_leap_settings(cli.leaps);
+  world.set_restart(cli.restart);
+  if (cli.control_variates)
+  {
+    world.set_control_variates(
+        {true, Model::primary_groups_mean_occupancy(scenario.topology)});
+  }
 
   world.init();
   if (scenario.do_before)
   {
     scenario.do_before();
   }
-  world.run(quiet);
+  world.run(quiet, cli.run_mode);
   if (scenario.do_after)
   {
     scenario.do_after();
@@ -39,3 +55,127 @@ run_scenario(ScenarioSettings &scenario, const Duration duration, bool use_rando
 
   scenario.stats = world.get_stats();
 }
+
+// The automatic run mode is resolved like in World::run(): the topologies of
+// the Poisson sources and the groups without compression are simulated by
+// states.
+static Simulation::RunMode
+resolved_run_mode(const Simulation::Topology &topology, Simulation::RunMode run_mode)
+{
+  if (run_mode != Simulation::RunMode::Auto)
+  {
+    return run_mode;
+  }
+  for (const auto &[name, source] : topology.sources)
+  {
+    std::ignore = name;
+    if (dynamic_cast<const Simulation::PoissonSourceStream *>(source.get()) == nullptr)
+    {
+      return Simulation::RunMode::Events;
+    }
+  }
+  for (const auto &[name, group] : topology.groups)
+  {
+    std::ignore = name;
+    if (!group->tcs_compression_.empty())
+    {
+      return Simulation::RunMode::Events;
+    }
+  }
+  return Simulation::RunMode::States;
+}
+
+// Relative cost of a scenario in the units of simulated events. The
+// simulation handles roughly a request and a service end per produced load.
+// A transition of the state-based run needs no event set, it is assumed to
+// cost state_transition_cost events. A leap replaces at least
+// leaps.min_transitions transitions, about half of the transitions are assumed
+// to be leapt, the others are taken exactly near the capacity. Every epoch
+// records the estimates of every traffic class in every group. With the
+// sequential stopping the run ends between the minimal number of the epochs
+// after the warm-up and its duration, the geometric mean of the bounds is
+// taken. The analytical models iterate over the states of every group for
+// every traffic class, a state in the high precision arithmetic is assumed to
+// cost as much as analytical_state_cost events. In the coupled sweep the
+// sources draw their candidate arrivals at the highest load of the sweep, a
+// rejected candidate costs only the draws, rejected_candidate_cost events.
+double
+estimate_cost(const ScenarioSettings &scenario, const CLIOptions &cli)
+{
+  constexpr double events_per_load = 2.0;
+  constexpr double state_transition_cost = 0.5;
+  constexpr double leapt_share = 0.5;
+  constexpr double epoch_record_cost = 10.0;
+  constexpr double rejected_candidate_cost = 0.2;
+  constexpr double analytical_state_cost = 100.0;
+
+  const auto &topology = scenario.topology;
+  switch (scenario.mode)
+  {
+    case Mode::Simulation:
+    {
+      double intensity = 0.0;
+      for (const auto &[name, source] : topology.sources)
+      {
+        std::ignore = name;
+        intensity += static_cast<double>(ts::get(source->tc_.source_intensity));
+      }
+
+      const auto duration = static_cast<double>(ts::get(cli.duration));
+      const auto epoch_duration = static_cast<double>(ts::get(cli.epochs.duration));
+      auto       simulated_time = duration;
+      if (cli.epochs.enabled() && cli.stop_condition.enabled())
+      {
+        const auto min_epochs =
+            static_cast<double>(cli.epochs.warmup + cli.stop_condition.min_epochs);
+        simulated_time =
+            std::sqrt(std::min(duration, min_epochs * epoch_duration) * duration);
+      }
+
+      auto cost = events_per_load * intensity * simulated_time;
+      switch (resolved_run_mode(topology, cli.run_mode))
+      {
+        case Simulation::RunMode::States:
+          cost *= state_transition_cost;
+          break;
+        case Simulation::RunMode::Leaps:
+          cost *= state_transition_cost
+                  * (1.0 - leapt_share
+                     + leapt_share / std::max(1.0, cli.leaps.min_transitions));
+          break;
+        case Simulation::RunMode::Auto:
+        case Simulation::RunMode::Events:
+        case Simulation::RunMode::Ticks:
+          break;
+      }
+
+      if (cli.coupled_sweep && scenario.thinning > 0.0)
+      {
+        cost += rejected_candidate_cost * (1.0 / scenario.thinning - 1.0) * intensity
+                * simulated_time;
+      }
+
+      if (cli.epochs.enabled())
+      {
+        const auto tc_records =
+            static_cast<double>(topology.groups.size() * topology.traffic_classes.size());
+        cost += epoch_record_cost * tc_records * simulated_time / epoch_duration;
+      }
+      return cost;
+    }
+    case Mode::Analytic:
+    {
+      double states = 0.0;
+      for (const auto &[name, group] : topology.groups)
+      {
+        std::ignore = name;
+        states += static_cast<double>(ts::get(group->total_capacity()) + 1)
+                  * static_cast<double>(topology.traffic_classes.size());
+      }
+      return analytical_state_cost * states;
+    }
+    case Mode::Test:
+      break;
+  }
+  return 0.0;
+}
@@ -20,6 +20,16 @@ struct ScenarioSettings
 
   std::string filename = "";
 
+  size_t index = 0; // in the order of loading
+
+  // Identify the random streams of the scenario, see Simulation::replication_key().
+  size_t stream_index = 0;
+  int    replication = 0;
+
+  // Fraction of the arrivals generated at the highest offered traffic of the
+  // sweep which are offered in this scenario, see SourceStream::set_thinning().
+  double thinning = 1.0;
+
   Mode                                                mode{Mode::Analytic};
   Model::AnalyticModel                                analytic_model{};
   boost::container::flat_map<Layer, Model::LayerType> layers_types{};
@@ -34,6 +44,5 @@ struct ScenarioSettings
   std::unique_ptr<Simulation::World> world{};
 };
 
-uint64_t seed(bool use_random_seed);
-void
-run_scenario(ScenarioSettings &scenario, const Duration duration, bool use_random_seed, bool quiet);
+void run_scenario(ScenarioSettings &scenario, const CLIOptions &cli, bool quiet);
+double   estimate_cost(const ScenarioSettings &scenario, const CLIOptions &cli);
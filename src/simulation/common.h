@@ -0,0 +1,141 @@
+#pragma once
+
+#include "types/types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace Simulation {
+enum class EventSetType {
+  // Binary heap over the pending events, kept as the reference implementation.
+  BinaryHeap,
+
+  // Calendar queue (R. Brown, 1988) with buckets resized to the number of pending events. O(1)
+  // amortized schedule/pop for the exponential holding times.
+  CalendarQueue
+};
+
+enum class RunMode {
+  // Events are popped one by one until the horizon is reached.
+  Events,
+
+  // Events are processed in batches of iterations advancing the clock at least by a tick, kept as
+  // the reference implementation.
+  Ticks,
+
+  // Transitions of the Markov chain of the system are sampled from the aggregate rates, without
+  // the service end events. Only for the Poisson sources without compression.
+  States,
+
+  // Approximation of States: far from the capacity of the groups the time advances in leaps in
+  // which the numbers of the arrivals and of the departures are drawn at once (see LeapSettings).
+  Leaps,
+
+  // States if the topology allows it, Events otherwise.
+  Auto
+};
+
+enum class ExponentialSamplerType {
+  // Ziggurat method in double precision.
+  Ziggurat,
+
+  // std::exponential_distribution in long double, kept as the reference implementation.
+  Reference
+};
+
+// Division of a run into epochs of equal simulated time. The stats of the groups are reset after
+// the warm-up epochs, the following epochs give the batch means of P_loss and P_block.
+struct EpochSettings
+{
+  // Simulated time of a single epoch, 0 disables the epochs.
+  Duration duration{0.0L};
+
+  // Number of the epochs discarded at the beginning of the run.
+  size_t warmup = 0;
+
+  bool enabled() const { return ts::get(duration) > 0.0L; }
+};
+
+// Automatic detection of the end of the warm-up. The total occupancy of the groups is sampled at
+// regular intervals and the stats of the groups are reset as soon as MSER-5 finds the truncation
+// point in the first half of the samples. It replaces the warm-up epochs.
+struct WarmupDetection
+{
+  bool enabled = false;
+
+  // Simulated time between the samples of the occupancy.
+  Duration sample_interval{10.0L};
+
+  // Number of the samples before the first detection attempt, it is doubled after every failed
+  // attempt.
+  size_t min_samples = 100;
+};
+
+// Sequential stopping of a run. It stops at the end of the epoch after which the estimates of
+// P_loss and P_block of every traffic class offered to every group are precise enough. The
+// duration of the run is the upper bound.
+struct StopCondition
+{
+  // Target relative half-width of the 95% confidence interval, 0 disables the criterion.
+  double relative_precision = 0.0;
+
+  // An estimate of a traffic class which lost at least that many requests is precise enough,
+  // 0 disables the criterion.
+  uint64_t min_lost = 0;
+
+  // The estimates from fewer epochs are not trusted.
+  size_t min_epochs = 10;
+
+  bool enabled() const { return relative_precision > 0.0 || min_lost > 0; }
+};
+
+// Tau-leaping (D. T. Gillespie, 2001) of the state-based run. A leap is taken only if no request
+// arriving during it can be blocked or lost, so the leaps change the occupancy but not the blocking
+// states; near the capacity of the groups the exact transitions are sampled.
+struct LeapSettings
+{
+  // Bound of the expected change during a leap, as a fraction of the free capacity left to the
+  // arrivals and of the occupancy left to the departures of every group.
+  double epsilon = 0.1;
+
+  // The leaps with fewer expected transitions are replaced by a single exact transition.
+  double min_transitions = 10.0;
+};
+
+// Importance splitting (RESTART, M. Villen-Altamirano and J. Villen-Altamirano, 1991) of the
+// state-based run for the rare blocking states. The importance of a state is the total occupancy
+// of the given groups. A trajectory crossing a threshold upwards is split into the given number of
+// retrials, the extra ones are killed as soon as they fall below that threshold. The time spent
+// above the k-th threshold is weighted by the inverse of the product of the first k numbers of
+// retrials, which keeps the estimates of P_block unbiased.
+struct RestartSettings
+{
+  // Groups whose occupancy is the importance, all the groups if empty (e.g. the groups of a layer).
+  std::vector<GroupName> groups{};
+
+  // Increasing thresholds of the importance, in the capacity units.
+  std::vector<double> thresholds{};
+
+  // Number of retrials at every threshold, a single value applies to all of them.
+  std::vector<size_t> retrials{};
+
+  // Number of the batches of the main trajectory which give the confidence intervals.
+  size_t batches = 20;
+
+  bool enabled() const { return !thresholds.empty(); }
+};
+
+// Control variates of the epoch estimates of P_loss and P_block. The controls are quantities of
+// an epoch with known expectation: the offered volume of the Poisson sources and the mean
+// occupancy of the groups listed here, whose mean occupancy is known from the analytical model.
+struct ControlVariates
+{
+  bool enabled = false;
+
+  // Expected occupancy of the groups, in the capacity units.
+  std::map<GroupName, double> mean_occupancy{};
+};
+
+} // namespace Simulation
@@ -2,6 +2,7 @@
 
 #include "group.h"
 #include "source_stream/source_stream.h"
+#include "topology.h"
 
 namespace Simulation {
 //----------------------------------------------------------------------
@@ -11,51 +12,42 @@ Event::Event(EventType type_, Uuid id_, Time time_) : type(type_), id(id_), time
 }
 
 void
-Event::clear_type()
+Event::skip_notify(Topology & /* topology */)
 {
-  type = EventType::None;
 }
 
 void
-Event::skip_event()
-{
-  skip = true;
-}
-
-void
-Event::skip_notify()
-{
-}
-
-void
-Event::process()
+Event::process(Topology & /* topology */)
 {
 }
 //----------------------------------------------------------------------
 
 LoadServiceRequestEvent::LoadServiceRequestEvent(Uuid id_, Load load_)
-  : Event(EventType::LoadServiceRequest, id_, load_.send_time), load(load_)
+  : Event(EventType::LoadServiceRequest, id_, load_.send_time), load(std::move(load_))
 {
 }
 
+// The sources read the load of the event after the service starts, so the
+// target group gets a copy, the groups further on the chain move it.
 void
-LoadServiceRequestEvent::process()
+LoadServiceRequestEvent::process(Topology &topology)
 {
-  load.produced_by->notify_on_request_service_start(this);
+  auto &source = topology.source_at(load.produced_by);
+  source.notify_on_request_service_start(this);
 
-  if (load.target_group->try_serve(load))
+  if (topology.group_at(load.target_group).try_serve(load))
   {
-    load.produced_by->notify_on_request_accept(this);
+    source.notify_on_request_accept(this);
   }
   else
   {
-    load.produced_by->notify_on_request_drop(this);
+    source.notify_on_request_drop(this);
   }
 }
 void
-LoadServiceRequestEvent::skip_notify()
+LoadServiceRequestEvent::skip_notify(Topology &topology)
 {
-  load.produced_by->notify_on_skip_processing(static_cast<Event *>(this));
+  topology.source_at(load.produced_by).notify_on_skip_processing(static_cast<Event *>(this));
 }
 
 //----------------------------------------------------------------------
@@ -69,12 +61,12 @@ ProduceServiceRequestEvent::ProduceServiceRequestEvent(
 }
 
 void
-ProduceServiceRequestEvent::process()
+ProduceServiceRequestEvent::process(Topology & /* topology */)
 {
   source_stream->notify_on_produce(this);
 }
 void
-ProduceServiceRequestEvent::skip_notify()
+ProduceServiceRequestEvent::skip_notify(Topology & /* topology */)
 {
   source_stream->notify_on_skip_processing(static_cast<Event *>(this));
 }
@@ -82,20 +74,20 @@ ProduceServiceRequestEvent::skip_notify()
 //----------------------------------------------------------------------
 
 LoadServiceEndEvent::LoadServiceEndEvent(Uuid id_, Load load_)
-  : Event(EventType::LoadServiceEnd, id_, load_.end_time), load((load_))
+  : Event(EventType::LoadServiceEnd, id_, load_.end_time), load(std::move(load_))
 {
 }
 
 void
-LoadServiceEndEvent::process()
+LoadServiceEndEvent::process(Topology &topology)
 {
-  load.served_by.back()->notify_on_request_service_end(this);
-  load.produced_by->notify_on_request_service_end(this);
+  topology.group_at(load.served_by.back()).notify_on_request_service_end(this);
+  topology.source_at(load.produced_by).notify_on_request_service_end(this);
 }
 void
-LoadServiceEndEvent::skip_notify()
+LoadServiceEndEvent::skip_notify(Topology &topology)
 {
-  load.produced_by->notify_on_skip_processing(static_cast<Event *>(this));
+  topology.source_at(load.produced_by).notify_on_skip_processing(static_cast<Event *>(this));
 }
 
 //----------------------------------------------------------------------
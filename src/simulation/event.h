@@ -8,27 +8,41 @@
 
 namespace Simulation {
 struct Event;
-using EventPtr = std::unique_ptr<Event>;
+class EventSlab;
+struct Topology;
+
+// Returns the event's slot to the slab of the World's event pool it was
+// allocated from.
+struct EventDeleter
+{
+  EventSlab *slab = nullptr;
+
+  void operator()(Event *event) const;
+};
+
+template <typename T>
+using PooledEventPtr = std::unique_ptr<T, EventDeleter>;
+using EventPtr = PooledEventPtr<Event>;
 
 enum class EventType { LoadServiceRequest, LoadServiceEnd, LoadProduce, None };
 
 //----------------------------------------------------------------------
+// Events are not polymorphic, the type selects the actual struct of the event
+// (see visit()), so no event carries a vtable and the dispatch is a switch. The
+// groups and sources of the loads are looked up in the topology by their
+// indices.
 
 struct Event
 {
   EventType type;
   Uuid      id;
   Time      time;
-  bool      skip = false;
+  bool      cancelled = false;
 
   Event(EventType type_, Uuid id_, Time time_);
-  void clear_type();
-  void skip_event();
-
-  virtual void process();
-  virtual void skip_notify();
 
-  virtual ~Event() = default;
+  void process(Topology &topology);
+  void skip_notify(Topology &topology);
 };
 
 //----------------------------------------------------------------------
@@ -39,8 +53,8 @@ struct LoadServiceRequestEvent : public Event
 
   LoadServiceRequestEvent(Uuid id, Load load_);
 
-  void process() override;
-  void skip_notify() override;
+  void process(Topology &topology);
+  void skip_notify(Topology &topology);
 };
 
 //----------------------------------------------------------------------
@@ -51,8 +65,8 @@ struct LoadServiceEndEvent : public Event
 
   LoadServiceEndEvent(Uuid id, Load load_);
 
-  void process() override;
-  void skip_notify() override;
+  void process(Topology &topology);
+  void skip_notify(Topology &topology);
 };
 
 //----------------------------------------------------------------------
@@ -65,12 +79,34 @@ struct ProduceServiceRequestEvent : public Event
   ProduceServiceRequestEvent(const ProduceServiceRequestEvent &) = delete;
   ProduceServiceRequestEvent &operator=(const ProduceServiceRequestEvent &) = delete;
 
-  void process() override;
-  void skip_notify() override;
+  void process(Topology &topology);
+  void skip_notify(Topology &topology);
 };
 
 //----------------------------------------------------------------------
 
+template <typename F>
+decltype(auto)
+visit(F &&f, Event &event)
+{
+  switch (event.type)
+  {
+    case EventType::LoadServiceRequest:
+      return f(static_cast<LoadServiceRequestEvent &>(event));
+    case EventType::LoadServiceEnd:
+      return f(static_cast<LoadServiceEndEvent &>(event));
+    case EventType::LoadProduce:
+      return f(static_cast<ProduceServiceRequestEvent &>(event));
+    case EventType::None:
+      break;
+  }
+  return f(event);
+}
+
+//----------------------------------------------------------------------
+
+// Orders events from the latest one, ties are resolved by the order of
+// scheduling.
 class by_time
 {
 public:
@@ -80,7 +116,7 @@ public:
     {
       return e1->time > e2->time;
     }
-    return e1->id < e1->id;
+    return e1->id > e2->id;
   }
   bool operator()(const Event &e1, const Event &e2) const
   {
@@ -88,7 +124,7 @@ public:
     {
       return e1.time > e2.time;
     }
-    return e1.id < e2.id;
+    return e1.id > e2.id;
   }
 };
 
@@ -20,7 +20,7 @@ struct formatter<Simulation::EventType>
   template <typename FormatContext>
   auto format(const Simulation::EventType &type, FormatContext &ctx)
   {
-    return format_to(ctx.begin(), [type]() {
+    return format_to(ctx.out(), "{}", [type]() {
       switch (type)
       {
         case Simulation::EventType::LoadServiceRequest:
@@ -49,7 +49,7 @@ struct formatter<Simulation::Event>
   auto format(const Simulation::Event &event, FormatContext &ctx)
   {
     return format_to(
-        ctx.begin(), "[Event: id={}, type={}, t={}]", event.id, event.type, event.time);
+        ctx.out(), "[Event: id={}, type={}, t={}]", event.id, event.type, event.time);
   }
   // format_arg(f, format_str, static_cast<const Event &>(event));
 };
@@ -66,7 +66,7 @@ struct formatter<Simulation::ProduceServiceRequestEvent>
   template <typename FormatContext>
   auto format(const Simulation::ProduceServiceRequestEvent &event, FormatContext &ctx)
   {
-    return format_to(ctx.begin(), "{}", static_cast<const Simulation::Event &>(event));
+    return format_to(ctx.out(), "{}", static_cast<const Simulation::Event &>(event));
   }
 };
 template <>
@@ -81,7 +81,7 @@ struct formatter<Simulation::LoadServiceEndEvent>
   template <typename FormatContext>
   auto format(const Simulation::LoadServiceEndEvent &event, FormatContext &ctx)
   {
-    return format_to(ctx.begin(), "{}", static_cast<const Simulation::Event &>(event));
+    return format_to(ctx.out(), "{}", static_cast<const Simulation::Event &>(event));
   }
 };
 template <>
@@ -96,7 +96,7 @@ struct formatter<Simulation::LoadServiceRequestEvent>
   template <typename FormatContext>
   auto format(const Simulation::LoadServiceRequestEvent &event, FormatContext &ctx)
   {
-    return format_to(ctx.begin(), "{}", static_cast<const Simulation::Event &>(event));
+    return format_to(ctx.out(), "{}", static_cast<const Simulation::Event &>(event));
   }
 };
 
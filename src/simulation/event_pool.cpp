@@ -0,0 +1,61 @@
+#include "event_pool.h"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace Simulation {
+//----------------------------------------------------------------------
+
+EventSlab::EventSlab(size_t slot_size, size_t slots_per_slab)
+  : slot_size_(std::max(slot_size, sizeof(FreeSlot))), slots_per_slab_(slots_per_slab)
+{
+}
+
+void *
+EventSlab::allocate()
+{
+  void *slot;
+  if (free_slots_ != nullptr)
+  {
+    slot = free_slots_;
+    free_slots_ = free_slots_->next;
+  }
+  else
+  {
+    if (next_slot_ == slab_end_)
+    {
+      auto &slab =
+          slabs_.emplace_back(std::make_unique_for_overwrite<std::byte[]>(slot_size_ * slots_per_slab_));
+      next_slot_ = slab.get();
+      slab_end_ = next_slot_ + slot_size_ * slots_per_slab_;
+    }
+    slot = next_slot_;
+    next_slot_ += slot_size_;
+  }
+  high_water_mark_ = std::max(high_water_mark_, ++in_use_);
+  return slot;
+}
+
+void
+EventSlab::deallocate(void *slot)
+{
+  free_slots_ = new (slot) FreeSlot{free_slots_};
+  --in_use_;
+}
+
+//----------------------------------------------------------------------
+
+void
+EventDeleter::operator()(Event *event) const
+{
+  visit(
+      [](auto &typed_event) {
+        using T = std::remove_reference_t<decltype(typed_event)>;
+        typed_event.~T();
+      },
+      *event);
+  slab->deallocate(event);
+}
+
+//----------------------------------------------------------------------
+} // namespace Simulation
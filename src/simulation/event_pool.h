@@ -0,0 +1,119 @@
+#pragma once
+
+#include "event.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Simulation {
+
+//----------------------------------------------------------------------
+// Allocator of fixed-size slots for a single event type. Slots are carved out
+// of slabs and recycled through an intrusive free list, so once the number of
+// pending events stabilizes no general-purpose allocation is made.
+class EventSlab
+{
+  struct FreeSlot
+  {
+    FreeSlot *next;
+  };
+
+  size_t slot_size_;
+  size_t slots_per_slab_;
+
+  std::vector<std::unique_ptr<std::byte[]>> slabs_{};
+  std::byte *                               next_slot_ = nullptr;
+  std::byte *                               slab_end_ = nullptr;
+  FreeSlot *                                free_slots_ = nullptr;
+
+  size_t in_use_ = 0;
+  size_t high_water_mark_ = 0;
+
+public:
+  EventSlab(size_t slot_size, size_t slots_per_slab);
+  EventSlab(const EventSlab &) = delete;
+  EventSlab &operator=(const EventSlab &) = delete;
+
+  void *allocate();
+  void  deallocate(void *slot);
+
+  size_t in_use() const { return in_use_; }
+  size_t high_water_mark() const { return high_water_mark_; }
+  size_t capacity() const { return slabs_.size() * slots_per_slab_; }
+};
+
+//----------------------------------------------------------------------
+template <typename T>
+struct EventTypeOf;
+
+template <>
+struct EventTypeOf<Event>
+{
+  static constexpr EventType value = EventType::None;
+};
+template <>
+struct EventTypeOf<LoadServiceRequestEvent>
+{
+  static constexpr EventType value = EventType::LoadServiceRequest;
+};
+template <>
+struct EventTypeOf<LoadServiceEndEvent>
+{
+  static constexpr EventType value = EventType::LoadServiceEnd;
+};
+template <>
+struct EventTypeOf<ProduceServiceRequestEvent>
+{
+  static constexpr EventType value = EventType::LoadProduce;
+};
+
+//----------------------------------------------------------------------
+// Per-World pool with a separate slab for each EventType.
+class EventPool
+{
+  static constexpr size_t slots_per_slab = 4096;
+
+  template <typename T>
+  static constexpr size_t slot_size()
+  {
+    constexpr auto alignment = alignof(std::max_align_t);
+    return (sizeof(T) + alignment - 1) / alignment * alignment;
+  }
+
+  static constexpr size_t index(EventType type) { return static_cast<size_t>(type); }
+
+  // The order has to follow the EventType enumerators
+  std::array<EventSlab, 4> slabs_{
+      EventSlab{slot_size<LoadServiceRequestEvent>(), slots_per_slab},
+      EventSlab{slot_size<LoadServiceEndEvent>(), slots_per_slab},
+      EventSlab{slot_size<ProduceServiceRequestEvent>(), slots_per_slab},
+      EventSlab{slot_size<Event>(), slots_per_slab}};
+
+public:
+  static constexpr std::array<EventType, 4> event_types{
+      EventType::LoadServiceRequest,
+      EventType::LoadServiceEnd,
+      EventType::LoadProduce,
+      EventType::None};
+
+  EventPool() = default;
+  EventPool(const EventPool &) = delete;
+  EventPool &operator=(const EventPool &) = delete;
+
+  template <typename T, typename... Args>
+  PooledEventPtr<T> make(Args &&...args)
+  {
+    auto &slab = slabs_[index(EventTypeOf<T>::value)];
+    auto *slot = slab.allocate();
+    return PooledEventPtr<T>{
+        new (slot) T(std::forward<Args>(args)...), EventDeleter{&slab}};
+  }
+
+  const EventSlab &slab(EventType type) const { return slabs_[index(type)]; }
+};
+
+} // namespace Simulation
@@ -0,0 +1,221 @@
+#include "event_set.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Simulation {
+//----------------------------------------------------------------------
+namespace {
+// Orders the entries of the heap like by_time orders the events.
+struct by_entry_time
+{
+  template <typename Entry>
+  bool operator()(const Entry &e1, const Entry &e2) const
+  {
+    if (e1.time != e2.time)
+    {
+      return e1.time > e2.time;
+    }
+    return e1.id > e2.id;
+  }
+};
+} // namespace
+
+void
+BinaryHeap::push(EventPtr event)
+{
+  const auto time = event->time;
+  const auto id = event->id;
+  events_.push_back(Entry{time, id, std::move(event)});
+  std::push_heap(begin(events_), end(events_), by_entry_time{});
+}
+
+const EventPtr &
+BinaryHeap::top()
+{
+  return events_.front().event;
+}
+
+EventPtr
+BinaryHeap::pop()
+{
+  std::pop_heap(begin(events_), end(events_), by_entry_time{});
+  auto event = std::move(events_.back().event);
+  events_.pop_back();
+  return event;
+}
+
+size_t
+BinaryHeap::remove_cancelled()
+{
+  const auto removed =
+      std::erase_if(events_, [](const auto &entry) { return entry.event->cancelled; });
+  std::make_heap(begin(events_), end(events_), by_entry_time{});
+  return removed;
+}
+
+//----------------------------------------------------------------------
+
+uint64_t
+CalendarQueue::day_of(Time time) const
+{
+  return static_cast<uint64_t>(ts::get(time) / width_);
+}
+
+void
+CalendarQueue::insert(EventPtr event)
+{
+  auto &bucket = buckets_[day_of(event->time) & mask_];
+  auto  position = std::upper_bound(begin(bucket), end(bucket), event, by_time{});
+  bucket.insert(position, std::move(event));
+}
+
+void
+CalendarQueue::find_earliest()
+{
+  // All pending events are scheduled not earlier than
+  // current_day_, so the first bucket holding an event from its current day
+  // holds the earliest event.
+  for (size_t i = 0; i < buckets_.size(); ++i, ++current_day_)
+  {
+    const auto &bucket = buckets_[current_day_ & mask_];
+    if (!bucket.empty() && day_of(bucket.back()->time) <= current_day_)
+    {
+      return;
+    }
+  }
+
+  // There is a gap longer than a year, look directly for the earliest event.
+  const EventPtr *earliest = nullptr;
+  for (const auto &bucket : buckets_)
+  {
+    if (!bucket.empty() && (earliest == nullptr || by_time{}(*earliest, bucket.back())))
+    {
+      earliest = &bucket.back();
+    }
+  }
+  current_day_ = day_of((*earliest)->time);
+}
+
+void
+CalendarQueue::resize(size_t buckets_number)
+{
+  std::vector<EventPtr> events;
+  events.reserve(size_);
+  for (auto &bucket : buckets_)
+  {
+    std::move(begin(bucket), end(bucket), std::back_inserter(events));
+  }
+
+  // Width of a day is estimated from the average separation of the earliest
+  // events, ignoring the separations larger than twice the average.
+  const auto sample_size = std::min(width_sample_size, events.size());
+  if (sample_size > 1)
+  {
+    std::vector<long double> times;
+    times.reserve(events.size());
+    for (const auto &event : events)
+    {
+      times.push_back(ts::get(event->time));
+    }
+    std::partial_sort(
+        begin(times), begin(times) + static_cast<ptrdiff_t>(sample_size), end(times));
+
+    const auto average_separation =
+        (times[sample_size - 1] - times[0]) / static_cast<long double>(sample_size - 1);
+    long double separations_sum = 0.0L;
+    size_t      separations_count = 0;
+    for (size_t i = 1; i < sample_size; ++i)
+    {
+      if (auto separation = times[i] - times[i - 1]; separation <= 2 * average_separation)
+      {
+        separations_sum += separation;
+        ++separations_count;
+      }
+    }
+    if (const auto width = 3 * separations_sum / static_cast<long double>(separations_count);
+        std::isnormal(width))
+    {
+      width_ = width;
+    }
+  }
+
+  buckets_ = std::vector<Bucket>(buckets_number);
+  mask_ = buckets_number - 1;
+  const EventPtr *earliest = nullptr;
+  for (auto &event : events)
+  {
+    if (earliest == nullptr || by_time{}(*earliest, event))
+    {
+      earliest = &event;
+    }
+  }
+  if (earliest != nullptr)
+  {
+    current_day_ = day_of((*earliest)->time);
+  }
+  for (auto &event : events)
+  {
+    insert(std::move(event));
+  }
+}
+
+void
+CalendarQueue::push(EventPtr event)
+{
+  if (const auto day = day_of(event->time); size_ == 0 || day < current_day_)
+  {
+    current_day_ = day;
+  }
+  insert(std::move(event));
+  if (++size_ > 2 * buckets_.size())
+  {
+    resize(2 * buckets_.size());
+  }
+}
+
+const EventPtr &
+CalendarQueue::top()
+{
+  find_earliest();
+  return buckets_[current_day_ & mask_].back();
+}
+
+EventPtr
+CalendarQueue::pop()
+{
+  find_earliest();
+  auto &bucket = buckets_[current_day_ & mask_];
+  auto  event = std::move(bucket.back());
+  bucket.pop_back();
+  if (--size_ < buckets_.size() / 2 && buckets_.size() > min_buckets_number)
+  {
+    resize(buckets_.size() / 2);
+  }
+  return event;
+}
+
+size_t
+CalendarQueue::remove_cancelled()
+{
+  size_t removed = 0;
+  for (auto &bucket : buckets_)
+  {
+    removed += std::erase_if(bucket, [](const auto &event) { return event->cancelled; });
+  }
+  size_ -= removed;
+
+  auto buckets_number = buckets_.size();
+  while (size_ < buckets_number / 2 && buckets_number > min_buckets_number)
+  {
+    buckets_number /= 2;
+  }
+  if (buckets_number != buckets_.size())
+  {
+    resize(buckets_number);
+  }
+  return removed;
+}
+
+//----------------------------------------------------------------------
+} // namespace Simulation
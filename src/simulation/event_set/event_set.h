@@ -0,0 +1,89 @@
+#pragma once
+
+#include "simulation/event.h"
+
+#include <vector>
+
+namespace Simulation {
+class EventSet;
+class BinaryHeap;
+class CalendarQueue;
+
+//----------------------------------------------------------------------
+// Set of pending events ordered by time, ties are resolved by the event id, so
+// every implementation yields the same sequence of events.
+class EventSet
+{
+public:
+  EventSet() = default;
+  EventSet(const EventSet &) = delete;
+  EventSet &operator=(const EventSet &) = delete;
+
+  virtual void            push(EventPtr event) = 0;
+  virtual const EventPtr &top() = 0;
+  virtual EventPtr        pop() = 0;
+  virtual size_t          size() const = 0;
+  bool                    empty() const { return size() == 0; }
+
+  // Removes all cancelled events and returns their number.
+  virtual size_t remove_cancelled() = 0;
+
+  virtual ~EventSet() = default;
+};
+
+//----------------------------------------------------------------------
+// The ordering key of an event is kept by value next to its pointer, so the
+// heap operations do not touch the events themselves.
+class BinaryHeap : public EventSet
+{
+  struct Entry
+  {
+    Time     time;
+    Uuid     id;
+    EventPtr event;
+  };
+
+  std::vector<Entry> events_{};
+
+public:
+  void            push(EventPtr event) override;
+  const EventPtr &top() override;
+  EventPtr        pop() override;
+  size_t          size() const override { return events_.size(); }
+  size_t          remove_cancelled() override;
+};
+
+//----------------------------------------------------------------------
+class CalendarQueue : public EventSet
+{
+  // Each bucket is sorted in the descending order, so the earliest event of
+  // the bucket is at its back.
+  using Bucket = std::vector<EventPtr>;
+
+  static constexpr size_t min_buckets_number = 2;
+  static constexpr size_t width_sample_size = 25;
+
+  std::vector<Bucket> buckets_ = std::vector<Bucket>(min_buckets_number);
+  size_t              mask_ = min_buckets_number - 1;
+  long double         width_ = 1.0L;
+
+  size_t size_ = 0;
+
+  // Index of the "day" (width long interval of time) the search of the next
+  // event starts from.
+  uint64_t current_day_ = 0;
+
+  uint64_t day_of(Time time) const;
+  void     insert(EventPtr event);
+  void     find_earliest();
+  void     resize(size_t buckets_number);
+
+public:
+  void            push(EventPtr event) override;
+  const EventPtr &top() override;
+  EventPtr        pop() override;
+  size_t          size() const override { return size_; }
+  size_t          remove_cancelled() override;
+};
+
+} // namespace Simulation
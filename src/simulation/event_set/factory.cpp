@@ -0,0 +1,19 @@
+#include "factory.h"
+
+#include "event_set.h"
+
+namespace Simulation {
+std::unique_ptr<EventSet>
+make_event_set(EventSetType type)
+{
+  switch (type)
+  {
+    case EventSetType::BinaryHeap:
+      return std::make_unique<BinaryHeap>();
+    case EventSetType::CalendarQueue:
+      return std::make_unique<CalendarQueue>();
+  }
+  return std::make_unique<BinaryHeap>();
+}
+
+} // namespace Simulation
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "simulation/common.h"
+
+#include <memory>
+
+namespace Simulation {
+class EventSet;
+
+std::unique_ptr<EventSet> make_event_set(EventSetType type);
+
+} // namespace Simulation
@@ -0,0 +1,36 @@
+#include "exponential.h"
+
+namespace Simulation {
+
+// The tables of the layers are built from the tail downwards, see the paper.
+ZigguratExponential::ZigguratExponential()
+{
+  double       de = r;
+  double       te = r;
+  const double q = v / std::exp(-de);
+
+  k[0] = static_cast<uint64_t>((de / q) * m);
+  k[1] = 0;
+  w[0] = q / m;
+  w[layers - 1] = de / m;
+  f[0] = 1.0;
+  f[layers - 1] = std::exp(-de);
+
+  for (size_t i = layers - 2; i >= 1; --i)
+  {
+    de = -std::log(v / de + std::exp(-de));
+    k[i + 1] = static_cast<uint64_t>((de / te) * m);
+    te = de;
+    f[i] = std::exp(-de);
+    w[i] = de / m;
+  }
+}
+
+const ZigguratExponential &
+ziggurat_exponential()
+{
+  static const ZigguratExponential ziggurat{};
+  return ziggurat;
+}
+
+} // namespace Simulation
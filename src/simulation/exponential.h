@@ -0,0 +1,90 @@
+#pragma once
+
+#include "common.h"
+#include "types/types.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+namespace Simulation {
+
+// Standard exponential variates by the ziggurat method (G. Marsaglia, W. W. Tsang, "The ziggurat
+// method for generating random variables", 2000) with 256 layers in double precision. Almost 99%
+// of the variates cost a single 64-bit number from the engine, a multiplication and a comparison.
+// The low 8 bits of the number select the layer, the high 53 bits the position in it.
+struct ZigguratExponential
+{
+  static constexpr size_t layers = 256;
+  static constexpr double r = 7.69711747013104972;  // start of the tail
+  static constexpr double v = 3.949659822581572e-3; // area of a layer
+  static constexpr double m = 9007199254740992.0;   // 2^53
+
+  std::array<uint64_t, layers> k{};
+  std::array<double, layers>   w{};
+  std::array<double, layers>   f{};
+
+  ZigguratExponential();
+
+  template <typename Engine>
+  static double uniform(Engine &engine)
+  {
+    return (static_cast<double>(engine() >> 11) + 0.5) / m;
+  }
+
+  template <typename Engine>
+  double operator()(Engine &engine) const
+  {
+    for (;;)
+    {
+      const uint64_t u = engine();
+      const auto     i = static_cast<size_t>(u & (layers - 1));
+      const auto     j = u >> 11;
+      const auto     x = static_cast<double>(j) * w[i];
+      if (j < k[i])
+      {
+        return x;
+      }
+      if (i == 0)
+      {
+        return r - std::log(uniform(engine));
+      }
+      if (f[i] + uniform(engine) * (f[i - 1] - f[i]) < std::exp(-x))
+      {
+        return x;
+      }
+    }
+  }
+};
+
+const ZigguratExponential &ziggurat_exponential();
+
+//----------------------------------------------------------------------
+// Exponential distribution with a fixed rate. The reference sampler is the
+// one the simulator used before, kept for validation.
+class ExponentialSampler
+{
+  double                                     mean_;
+  std::exponential_distribution<time_type<>> reference_;
+
+public:
+  explicit ExponentialSampler(time_type<> rate)
+    : mean_(static_cast<double>(1.0L / rate)), reference_(rate)
+  {
+  }
+
+  double mean() const { return mean_; }
+
+  template <typename Engine>
+  time_type<> operator()(Engine &engine, ExponentialSamplerType type)
+  {
+    if (type == ExponentialSamplerType::Reference)
+    {
+      return reference_(engine);
+    }
+    return mean_ * ziggurat_exponential()(engine);
+  }
+};
+
+} // namespace Simulation
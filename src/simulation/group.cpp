@@ -49,19 +49,27 @@ void
 Group::set_world(World &world)
 {
   world_ = &world;
+  random_engine_ = world.make_random_engine(ts::get(id));
+  exponential_type_ = world.get_exponential_sampler();
   overflow_policy_->set_world(world);
 }
 
 void
 Group::set_end_time(Load &load, IntensityFactor intensity_factor)
 {
-  const auto &tcs = *traffic_classes_;
-  const auto  serve_intensity =
-      intensity_factor * tcs.at(load.tc_id).serve_intensity;
-  auto params = decltype(exponential)::param_type(ts::get(serve_intensity));
-  exponential.param(params);
+  const auto &attributes = tcs_attributes_[load.tc_index];
+  if (exponential_type_ == ExponentialSamplerType::Reference)
+  {
+    const auto serve_intensity = intensity_factor * attributes.tc->serve_intensity;
+    auto params = decltype(exponential)::param_type(ts::get(serve_intensity));
+    exponential.param(params);
 
-  Duration t_serv{exponential(world_->get_random_engine())};
+    Duration t_serv{exponential(random_engine_)};
+    load.end_time = load.send_time + t_serv;
+    return;
+  }
+  const auto mean = attributes.mean_service_time / static_cast<double>(ts::get(intensity_factor));
+  Duration   t_serv{mean * ziggurat_exponential()(random_engine_)};
   load.end_time = load.send_time + t_serv;
 }
 
@@ -77,6 +85,51 @@ Group::set_traffic_classes(const TrafficClasses &traffic_classes)
   traffic_classes_ = &traffic_classes;
 }
 
+void
+Group::compile()
+{
+  std::vector<TrafficClassId> tc_ids;
+  tcs_attributes_.clear();
+  for (const auto &[tc_id, tc] : *traffic_classes_)
+  {
+    CompressionRatios *compression_ratios = nullptr;
+    if (auto it = tcs_compression_.find(tc_id); it != end(tcs_compression_))
+    {
+      compression_ratios = &it->second;
+    }
+    tcs_attributes_.push_back(TrafficClassAttributes{
+        &tc,
+        compression_ratios,
+        tcs_block_.find(tc_id) != end(tcs_block_),
+        static_cast<double>(1.0L / ts::get(tc.serve_intensity)),
+        static_cast<double>(ts::get(tc.serve_intensity))});
+    tc_ids.push_back(tc_id);
+  }
+  in_service_.assign(tcs_attributes_.size(), {});
+  loads_in_service_ = 0;
+  departure_rate_ = 0.0;
+  stats_.set_traffic_classes(std::move(tc_ids));
+
+  const auto max_capacity = ts::get(*std::max_element(begin(capacity_), end(capacity_)));
+  tcs_by_size_.clear();
+  tcs_checked_always_.clear();
+  for (size_t tc_index = 0; tc_index < tcs_attributes_.size(); ++tc_index)
+  {
+    const auto &attributes = tcs_attributes_[tc_index];
+    if (attributes.blocked || attributes.compression_ratios != nullptr
+        || ts::get(attributes.tc->size) > max_capacity)
+    {
+      tcs_checked_always_.emplace_back(tc_index);
+      continue;
+    }
+    tcs_by_size_.emplace_back(tc_index);
+  }
+  std::stable_sort(begin(tcs_by_size_), end(tcs_by_size_), [&](size_t lhs, size_t rhs) {
+    return tcs_attributes_[lhs].tc->size < tcs_attributes_[rhs].tc->size;
+  });
+  previous_groups_.clear();
+}
+
 void
 Group::set_overflow_policy(std::unique_ptr<OverflowPolicy> overflow_policy)
 {
@@ -106,12 +159,81 @@ Group::notify_on_request_service_end(LoadServiceEndEvent *event)
   take_off(event->load);
 }
 
+size_t
+Group::departing_tc_index(double u) const
+{
+  size_t departing_tc_index = 0;
+  for (size_t tc_index = 0; tc_index < in_service_.size(); ++tc_index)
+  {
+    const auto rate = departure_rate(tc_index);
+    if (rate <= 0.0)
+    {
+      continue;
+    }
+    // The last non-empty class takes the remainder of the rounding errors
+    departing_tc_index = tc_index;
+    u -= rate;
+    if (u < 0.0)
+    {
+      break;
+    }
+  }
+  return departing_tc_index;
+}
+
+void
+Group::start_service(Load load)
+{
+  const auto rate = tcs_attributes_[load.tc_index].service_rate;
+  in_service_[load.tc_index].push_back(std::move(load));
+  ++loads_in_service_;
+  departure_rate_ += rate;
+  world_->add_departure_rate(rate);
+}
+
+// The rate of an empty group is reset, so the rounding errors do not add up over the run.
+void
+Group::end_service(size_t tc_index, Time time)
+{
+  auto load = std::move(in_service_[tc_index].back());
+  in_service_[tc_index].pop_back();
+  const auto rate = tcs_attributes_[tc_index].service_rate;
+  --loads_in_service_;
+  departure_rate_ = loads_in_service_ == 0 ? 0.0 : departure_rate_ - rate;
+  world_->remove_departure_rate(rate);
+  load.end_time = time;
+  take_off(load);
+}
+
+void
+Group::restore_state(const GroupState &state)
+{
+  size_ = state.size;
+  free_capacity_ = state.free_capacity;
+  in_service_ = state.in_service;
+  stats_ = state.stats;
+  loads_in_service_ = 0;
+  departure_rate_ = 0.0;
+  for (size_t tc_index = 0; tc_index < in_service_.size(); ++tc_index)
+  {
+    loads_in_service_ += in_service_[tc_index].size();
+    departure_rate_ += departure_rate(tc_index);
+  }
+}
+
 bool
 Group::try_serve(Load load)
 {
-  load.served_by.emplace_back(this);
+  ASSERT(
+      load.served_by.size() < MaxServedByLength,
+      "Load {} offered to group {} has already visited {} groups, see Topology::compile().",
+      load.id,
+      name_,
+      MaxServedByLength);
+  load.served_by.push_back(index_);
+  load.layers_usage[layer_]++;
 
-  if (auto [ok, compression, bucket] = can_serve(load.tc_id); ok)
+  if (auto [ok, compression, bucket] = can_serve(load.tc_index); ok)
   {
     std::ignore = bucket;
     IntensityFactor intensity_factor{1.0l};
@@ -122,80 +244,168 @@ Group::try_serve(Load load)
       load.compression_ratio = compression;
     }
     debug_print("{} Start serving request: {}\n", *this, load);
+    stats_.add_occupancy(occupancy(), load.send_time);
     size_[bucket] += load.size;
-    load.bucket = bucket;
+    free_capacity_[bucket] = capacity_[bucket] - size_[bucket];
+    load.bucket = static_cast<uint32_t>(bucket);
+    if (world_->is_state_based())
+    {
+      update_block_stat(load);
+      start_service(std::move(load));
+      return true;
+    }
     set_end_time(load, intensity_factor);
 
     update_block_stat(load);
 
-    world_->schedule(
-        std::make_unique<LoadServiceEndEvent>(world_->get_uuid(), load));
+    world_->schedule(world_->make_event<LoadServiceEndEvent>(
+        world_->get_uuid(), std::move(load)));
     return true;
   }
   debug_print("{} Forwarding request: {}\n", *this, load);
-  return forward(load);
+  return forward(std::move(load));
 }
 
 void
 Group::take_off(const Load &load)
 {
   debug_print("{} Request has been served: {}\n", *this, load);
+  stats_.add_occupancy(occupancy(), load.end_time);
   size_[load.bucket] -= load.size;
+  free_capacity_[load.bucket] = capacity_[load.bucket] - size_[load.bucket];
   update_unblock_stat(load);
-  stats_.served_by_tc[load.tc_id].serve(load);
+  stats_.served_by_tc[load.tc_index].serve(load);
 }
 void
 Group::drop(const Load &load)
 {
   debug_print("{} Request has been dropped: {}\n", *this, load);
-  stats_.served_by_tc[load.tc_id].drop(load);
+  stats_.served_by_tc[load.tc_index].drop(load.size);
+}
+
+// The block state of a traffic class is updated only if it can change. The
+// local state changes only for the classes whose sizes are passed by the
+// largest free capacity of the buckets. The recursive state of a class also
+// depends on the groups the class overflows to, so a change of the state of
+// a group is passed to the groups which overflow to it.
+int64_t
+Group::max_free_capacity() const
+{
+  int64_t max_free = 0;
+  for (const auto &free_capacity : free_capacity_)
+  {
+    max_free = std::max(max_free, ts::get(free_capacity));
+  }
+  return max_free;
 }
 
 void
 Group::update_unblock_stat(const Load &load)
 {
-  for (const auto &[tc_id, tc] : *traffic_classes_)
+  auto previous_max_free = ts::get(free_capacity_[load.bucket]) - ts::get(load.size);
+  for (size_t bucket = 0; bucket < free_capacity_.size(); ++bucket)
   {
-    std::ignore = tc_id;
-    Path path; // = load.path; // NOTE(PW): should be considered length of the
-               // current
-    if (auto [recursive, local] = can_serve_recursive(tc, path); local)
+    if (bucket != load.bucket)
     {
-      unblock_recursive(tc.id, load);
-      unblock(tc.id, load);
+      previous_max_free = std::max(previous_max_free, ts::get(free_capacity_[bucket]));
     }
-    else if (recursive)
-    {
-      unblock_recursive(tc.id, load);
-    }
-    ASSERT(path.size() == 0 /*load.path.size() */, "Path should be empty.");
   }
+  update_block_states(previous_max_free, max_free_capacity(), load);
 }
+
 void
 Group::update_block_stat(const Load &load)
 {
-  for (const auto &[tc_id, tc] : *traffic_classes_)
+  const auto max_free = max_free_capacity();
+  update_block_states(
+      max_free,
+      std::max(max_free, ts::get(free_capacity_[load.bucket]) + ts::get(load.size)),
+      load);
+}
+
+// Updates the classes of the sizes in (lower_free, upper_free] and those
+// checked always.
+void
+Group::update_block_states(int64_t lower_free, int64_t upper_free, const Load &load)
+{
+  const auto first_larger = [&](int64_t max_free) {
+    return std::upper_bound(
+        begin(tcs_by_size_), end(tcs_by_size_), max_free, [&](int64_t value, size_t tc_index) {
+          return value < ts::get(tcs_attributes_[tc_index].tc->size);
+        });
+  };
+  for (auto it = first_larger(lower_free), last = first_larger(upper_free); it != last; ++it)
   {
-    std::ignore = tc_id;
-    Path path; // = load.path; // NOTE(PW): should be considered length of the
-               // current
-    if (auto [recursive, local] = can_serve_recursive(tc, path);
-        !local && recursive)
-    {
-      block(tc.id, load);
-    }
-    else if (!recursive)
+    update_block_state(*it, load);
+  }
+  for (const auto tc_index : tcs_checked_always_)
+  {
+    update_block_state(tc_index, load);
+  }
+}
+
+void
+Group::update_block_state(size_t tc_index, const Load &load)
+{
+  const auto was_blocked = stats_.blocked_by_tc[tc_index].is_blocked;
+  const auto was_blocked_recursive = stats_.blocked_recursive_by_tc[tc_index].is_blocked;
+  if (can_serve(tc_index).can_serve)
+  {
+    unblock_recursive(tc_index, load);
+    unblock(tc_index, load);
+  }
+  else
+  {
+    block(tc_index, load);
+    update_recursive_block_state(tc_index, load);
+  }
+  if (was_blocked != stats_.blocked_by_tc[tc_index].is_blocked
+      || was_blocked_recursive != stats_.blocked_recursive_by_tc[tc_index].is_blocked)
+  {
+    notify_previous_groups(tc_index, load);
+  }
+}
+
+void
+Group::update_recursive_block_state(size_t tc_index, const Load &load)
+{
+  Path path;
+  if (can_serve_recursive(tc_index, path).recursively)
+  {
+    unblock_recursive(tc_index, load);
+  }
+  else
+  {
+    block_recursive(tc_index, load);
+  }
+  ASSERT(path.size() == 0, "Path should be empty.");
+}
+
+// The recursive check of a group passes only through the groups which cannot
+// serve the class locally, so only those are visited upstream.
+void
+Group::notify_previous_groups(size_t tc_index, const Load &load)
+{
+  std::vector<Group *> groups{this};
+  for (size_t i = 0; i < groups.size(); ++i)
+  {
+    for (auto *previous_group : groups[i]->previous_groups_)
     {
-      block_recursive(tc.id, load);
-      block(tc.id, load);
+      if (std::find(begin(groups), end(groups), previous_group) != end(groups)
+          || previous_group->can_serve(tc_index).can_serve)
+      {
+        continue;
+      }
+      previous_group->update_recursive_block_state(tc_index, load);
+      groups.emplace_back(previous_group);
     }
-    ASSERT(path.size() == 0 /*load.path.size() */, "Path should be empty.");
   }
 }
+
 void
-Group::block(TrafficClassId tc_id, const Load &load)
+Group::block(size_t tc_index, const Load &load)
 {
-  auto &block_stats = stats_.blocked_by_tc[tc_id];
+  auto &block_stats = stats_.blocked_by_tc[tc_index];
   if (block_stats.try_block(load.send_time))
   {
     debug_print(
@@ -208,9 +418,9 @@ Group::block(TrafficClassId tc_id, const Load &load)
 }
 
 void
-Group::unblock(TrafficClassId tc_id, const Load &load)
+Group::unblock(size_t tc_index, const Load &load)
 {
-  auto &block_stats = stats_.blocked_by_tc[tc_id];
+  auto &block_stats = stats_.blocked_by_tc[tc_index];
   if (block_stats.try_unblock(load.end_time))
   {
     debug_print(
@@ -219,9 +429,9 @@ Group::unblock(TrafficClassId tc_id, const Load &load)
 }
 
 void
-Group::block_recursive(TrafficClassId tc_id, const Load &load)
+Group::block_recursive(size_t tc_index, const Load &load)
 {
-  auto &block_stats = stats_.blocked_recursive_by_tc[tc_id];
+  auto &block_stats = stats_.blocked_recursive_by_tc[tc_index];
   if (block_stats.try_block(load.send_time))
   {
     debug_print(
@@ -234,9 +444,9 @@ Group::block_recursive(TrafficClassId tc_id, const Load &load)
 }
 
 void
-Group::unblock_recursive(TrafficClassId tc_id, const Load &load)
+Group::unblock_recursive(size_t tc_index, const Load &load)
 {
-  auto &block_stats = stats_.blocked_recursive_by_tc[tc_id];
+  auto &block_stats = stats_.blocked_recursive_by_tc[tc_index];
   if (block_stats.try_unblock(load.end_time))
   {
     debug_print(
@@ -246,27 +456,23 @@ Group::unblock_recursive(TrafficClassId tc_id, const Load &load)
         block_stats.block_time);
   }
 }
-CanServeResult
-Group::can_serve(TrafficClassId tc_id)
-{
-  return can_serve(traffic_classes_->at(tc_id));
-}
 
 CanServeResult
-Group::can_serve(const TrafficClass &tc)
+Group::can_serve(size_t tc_index)
 {
-  if (tcs_block_.find(tc.id) != end(tcs_block_))
+  const auto &attributes = tcs_attributes_[tc_index];
+  if (attributes.blocked)
   {
     return {false, nullptr, 0};
   }
-  if (const auto tc_compression_it = tcs_compression_.find(tc.id);
-      tc_compression_it != end(tcs_compression_))
+  if (attributes.compression_ratios != nullptr)
   {
+    auto &compression_ratios = *attributes.compression_ratios;
     for (size_t bucket = {0}; bucket < size_.size(); ++bucket)
     {
-      if (const auto cr_it = tc_compression_it->second.lower_bound(
-              Capacity{get(size_[bucket])});
-          cr_it != end(tc_compression_it->second))
+      if (const auto cr_it =
+              compression_ratios.lower_bound(Capacity{get(size_[bucket])});
+          cr_it != end(compression_ratios))
       {
         // TODO(PW): verify if the condition is correct with multiple buckets
         return {size_[bucket] + cr_it->second.size <= capacity_[bucket],
@@ -275,6 +481,7 @@ Group::can_serve(const TrafficClass &tc)
       }
     }
   }
+  const auto &tc = *attributes.tc;
   for (size_t bucket = {0}; bucket < size_.size(); ++bucket)
   {
     if (size_[bucket] + tc.size <= capacity_[bucket])
@@ -286,9 +493,9 @@ Group::can_serve(const TrafficClass &tc)
 }
 
 CanServeRecursiveResult
-Group::can_serve_recursive(const TrafficClass &tc, Path &path)
+Group::can_serve_recursive(size_t tc_index, Path &path)
 {
-  if (auto [ok, compression, bucket] = can_serve(tc); ok)
+  if (auto [ok, compression, bucket] = can_serve(tc_index); ok)
   {
     std::ignore = compression;
     std::ignore = bucket;
@@ -297,7 +504,7 @@ Group::can_serve_recursive(const TrafficClass &tc, Path &path)
   path.emplace_back(this);
   auto pop_on_exit = gsl::finally([&path]() { path.pop_back(); });
 
-  if (path.size() >= tc.max_path_length)
+  if (path.size() >= tcs_attributes_[tc_index].tc->max_path_length)
   {
     return {false, false};
   }
@@ -307,7 +514,7 @@ Group::can_serve_recursive(const TrafficClass &tc, Path &path)
     if (std::find(std::begin(path), std::end(path), next_group)
         == std::end(path))
     {
-      return {bool(next_group->can_serve_recursive(tc, path)), false};
+      return {bool(next_group->can_serve_recursive(tc_index, path)), false};
     }
   }
   return {false, false};
@@ -318,23 +525,25 @@ Group::forward(Load load)
 {
   // TODO(PW): if the max path has been reached, pass the load to the next
   // layer
-  if (load.drop
-      || load.served_by.size()
-             >= traffic_classes_->at(load.tc_id).max_path_length)
+  if (load.drop || load.served_by.size() >= tcs_attributes_[load.tc_index].tc->max_path_length)
   {
     drop(load);
     return false;
   }
   if (auto next_group = overflow_policy_->find_next_group(load); next_group)
   {
-    auto is_served = (*next_group)->try_serve(load);
+    // The load is moved to the next group, which may compress it, the local
+    // stats count the size offered to this group
+    auto      &tc_stats = stats_.served_by_tc[load.tc_index];
+    const auto size = load.size;
+    auto       is_served = (*next_group)->try_serve(std::move(load));
     if (!is_served)
     { // migrated load is considered as dropped by the local group
-      drop(load);
+      tc_stats.drop(size);
     }
     else
     {
-      stats_.served_by_tc[load.tc_id].forward(load);
+      tc_stats.forward(size);
     }
     return is_served;
   }
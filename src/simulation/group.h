@@ -1,7 +1,9 @@
 #pragma once
 
+#include "exponential.h"
 #include "load.h"
 #include "overflow_policy/overflow_policy.h"
+#include "random.h"
 #include "stats.h"
 #include "traffic_class.h"
 #include "types/types.h"
@@ -34,16 +36,29 @@ struct CanServeResult
 using CompressionRatios =
     boost::container::flat_map<Capacity, CompressionRatio, std::greater<Capacity>>;
 
+// Attributes of a traffic class in the group, addressed by the dense index of
+// the class (see Topology::compile()).
+struct TrafficClassAttributes
+{
+  const TrafficClass *tc = nullptr;
+  CompressionRatios * compression_ratios = nullptr;
+  bool                blocked = false;
+  double              mean_service_time = 0.0;
+  double              service_rate = 0.0;
+};
+
 std::vector<Capacity>
 operator-(const std::vector<Capacity> &capacities, const std::vector<Size> &sizes);
 
 struct Group
 {
   GroupId               id{};
+  uint32_t              index_{}; // see Topology::compile()
   const GroupName       name_;
   std::vector<Capacity> capacity_;
   Capacity              total_capacity_ = ranges::accumulate(capacity_, Capacity{});
   std::vector<Size>     size_{};
+  std::vector<Capacity> free_capacity_ = capacity_ - size_;
   Layer                 layer_;
 
   GroupStatistics stats_{};
@@ -51,15 +66,34 @@ struct Group
   World *                         world_ = nullptr;
   const TrafficClasses *          traffic_classes_{};
   std::vector<Group *>            next_groups_{};
+  std::vector<Group *>            previous_groups_{}; // see Topology::compile()
   std::unique_ptr<OverflowPolicy> overflow_policy_;
 
   boost::container::flat_map<TrafficClassId, CompressionRatios> tcs_compression_{};
   std::unordered_set<TrafficClassId>                            tcs_block_{};
-
+  std::vector<TrafficClassAttributes>                           tcs_attributes_{};
+
+  // A class without compression can be served locally if its size does not exceed the largest
+  // free capacity of the buckets, so only the classes of the sizes passed by that capacity change
+  // their local block state. The indices of those classes are sorted by the size, the others are
+  // checked on every change of the occupancy.
+  std::vector<size_t> tcs_by_size_{};
+  std::vector<size_t> tcs_checked_always_{};
+
+  // Loads in service in the state-based run (see World::run_states()) by the index of the traffic
+  // class. Their holding times are not drawn, the departures are sampled from the total rates.
+  // The total departure rate of the group is kept up to date, as the one of the world.
+  std::vector<std::vector<Load>> in_service_{};
+  size_t                         loads_in_service_ = 0;
+  double                         departure_rate_ = 0.0;
+
+  Philox                                     random_engine_{};
+  ExponentialSamplerType                     exponential_type_{};
   std::exponential_distribution<time_type<>> exponential{};
 
   void                        set_world(World &world);
   void                        set_traffic_classes(const TrafficClasses &traffic_classes);
+  void                        compile();
   void                        set_overflow_policy(std::unique_ptr<OverflowPolicy> overflow_policy);
   void                        add_next_group(Group &group);
   const std::vector<Group *> &next_groups() { return next_groups_; }
@@ -75,21 +109,29 @@ struct Group
 
   bool forward(Load load);
 
-  std::vector<Capacity> free_capacity() { return capacity_ - size_; }
+  const std::vector<Capacity> &free_capacity() const { return free_capacity_; }
   std::vector<Capacity> capacity() { return capacity_; }
   Capacity              total_capacity() { return total_capacity_; }
   Layer                 layer() { return layer_; }
+  long double           occupancy() const
+  {
+    return static_cast<long double>(ts::get(ranges::accumulate(size_, Size{})));
+  }
 
-  CanServeResult          can_serve(const TrafficClass &tc);
-  CanServeResult          can_serve(TrafficClassId tc_id);
-  CanServeRecursiveResult can_serve_recursive(const TrafficClass &tc, Path &path);
-
-  void block_recursive(TrafficClassId tc_id, const Load &load);
-  void unblock_recursive(TrafficClassId tc_id, const Load &load);
-  void block(TrafficClassId tc_id, const Load &load);
-  void unblock(TrafficClassId tc_id, const Load &load);
-  void update_block_stat(const Load &load);
-  void update_unblock_stat(const Load &load);
+  CanServeResult          can_serve(size_t tc_index);
+  CanServeRecursiveResult can_serve_recursive(size_t tc_index, Path &path);
+
+  void    block_recursive(size_t tc_index, const Load &load);
+  void    unblock_recursive(size_t tc_index, const Load &load);
+  void    block(size_t tc_index, const Load &load);
+  void    unblock(size_t tc_index, const Load &load);
+  int64_t max_free_capacity() const;
+  void    update_block_stat(const Load &load);
+  void    update_unblock_stat(const Load &load);
+  void    update_block_states(int64_t lower_free, int64_t upper_free, const Load &load);
+  void    update_block_state(size_t tc_index, const Load &load);
+  void    update_recursive_block_state(size_t tc_index, const Load &load);
+  void    notify_previous_groups(size_t tc_index, const Load &load);
 
   Group(GroupName name, Capacity capacity, Layer layer);
   Group(GroupName name, Capacity capacity);
@@ -102,6 +144,22 @@ struct Group
 
   void notify_on_request_service_end(LoadServiceEndEvent *event);
 
+  double departure_rate(size_t tc_index) const
+  {
+    return static_cast<double>(in_service_[tc_index].size())
+           * tcs_attributes_[tc_index].service_rate;
+  }
+  double departure_rate() const { return departure_rate_; }
+  void   start_service(Load load);
+  void   end_service(size_t tc_index, Time time);
+
+  // Class of the departing load in the state-based run, u is uniform on the departure rate of the
+  // group (see World::exact_transition()).
+  size_t departing_tc_index(double u) const;
+
+  GroupState save_state() const { return {size_, free_capacity_, in_service_, stats_}; }
+  void       restore_state(const GroupState &state);
+
   Stats            get_stats(Duration duration);
   const GroupName &name() const { return name_; }
 };
@@ -1,10 +1,15 @@
 #pragma once
 
+#include "config.h"
 #include "traffic_class.h"
 #include "types/types.h"
 
-#include <boost/container/small_vector.hpp>
+#include <algorithm>
+#include <array>
+#include <boost/container/static_vector.hpp>
+#include <cstdint>
 #include <fmt/format.h>
+#include <tuple>
 #include <vector>
 
 namespace Simulation {
@@ -17,22 +22,64 @@ struct CompressionRatio
   IntensityFactor intensity_factor;
 };
 
-using Path = boost::container::small_vector<Group *, 5>;
+// The path is kept inline in the load, Topology::compile() rejects the
+// topologies in which a load could visit more groups.
+constexpr size_t MaxServedByLength = 8;
 
+using Path = boost::container::static_vector<Group *, MaxServedByLength>;
+using LayersUsage = std::array<uint8_t, MaxLayersNumber>;
+
+// Groups visited by a load, by their indices (see Topology::compile()). Without
+// Config::record_load_path only the number of the hops and the last group are
+// kept, Topology::compile() then requires the overflow graph to be acyclic, so
+// no group can be visited twice.
+class LoadPath
+{
+  static constexpr bool recorded_ = Config::record_load_path;
+
+  std::array<uint32_t, recorded_ ? MaxServedByLength : 1> groups_{};
+  uint8_t                                                 hops_ = 0;
+
+public:
+  void push_back(uint32_t group_index)
+  {
+    groups_[recorded_ ? hops_ : 0] = group_index;
+    ++hops_;
+  }
+  uint32_t back() const { return groups_[recorded_ ? hops_ - 1 : 0]; }
+  size_t   size() const { return hops_; }
+  bool     contains(uint32_t group_index) const
+  {
+    if constexpr (recorded_)
+    {
+      return std::find(begin(groups_), begin(groups_) + hops_, group_index)
+             != begin(groups_) + hops_;
+    }
+    else
+    {
+      std::ignore = group_index;
+      return false;
+    }
+  }
+};
+
+// Groups and sources are addressed by their dense indices (see
+// Topology::compile()), the load is moved along the overflow chain.
 struct Load
 {
   LoadId            id{};
   TrafficClassId    tc_id{};
+  uint32_t          tc_index{}; // see Topology::compile()
+  uint32_t          bucket{};
+  uint32_t          produced_by{};
+  uint32_t          target_group{};
+  LayersUsage       layers_usage{}; // number of groups from each layer in served_by
+  bool              drop = false;
   Time              send_time{};
   Size              size{};
-  size_t            bucket{};
   Time              end_time{-1};
-  bool              drop = false;
   CompressionRatio *compression_ratio = nullptr;
-
-  Path          served_by{};
-  SourceStream *produced_by = nullptr;
-  Group *       target_group = nullptr;
+  LoadPath          served_by{};
 };
 
 } // namespace Simulation
@@ -6,6 +6,7 @@
 #include "simulation/source_stream/source_stream.h"
 #include "utils.h"
 
+#include <functional>
 #include <type_traits>
 
 namespace Simulation {
@@ -26,54 +27,76 @@ OverflowPolicy::pick_random(BeginIt &&begin, EndIt &&end)
   return get_random_element(begin, end, world_->get_random_engine());
 }
 
-std::array<int, MaxLayersNumber>
-OverflowPolicy::count_layers_usage(const Path &path) const
-{
-  std::array<int, MaxLayersNumber> layers_usage_counter{0};
-  for (const auto &group : path)
-  {
-    layers_usage_counter[group->layer_]++;
-  }
-  return layers_usage_counter;
-}
-std::vector<Group *>
+const std::vector<Group *> &
 OverflowPolicy::get_available_groups(const Load &load, Layer layer)
 {
-  const auto           layers_usage = count_layers_usage(load.served_by);
-  std::vector<Group *> available_groups;
+  const auto &layers_usage = load.layers_usage;
 
-  available_groups.reserve(group_->next_groups_.size());
+  available_groups_.clear();
   std::copy_if(
       begin(group_->next_groups_),
       end(group_->next_groups_),
-      back_inserter(available_groups),
+      back_inserter(available_groups_),
       [&](const auto &group) {
         return layers_usage[group->layer_] < overflows_per_layer && group->layer_ == layer
-               && group->can_serve(load.tc_id).can_serve && !contains(load.served_by, group);
+               && group->can_serve(load.tc_index).can_serve
+               && !load.served_by.contains(group->index_);
       });
-  return available_groups;
+  return available_groups_;
 }
 
 std::optional<Group *>
 OverflowPolicy::fallback_policy()
 {
-  std::vector<Group *> available_groups;
-
-  available_groups.reserve(group_->next_groups_.size());
   auto current_layer = group_->layer_;
+  available_groups_.clear();
   std::copy_if(
       begin(group_->next_groups_),
       end(group_->next_groups_),
-      back_inserter(available_groups),
+      back_inserter(available_groups_),
       [current_layer](const auto &group) { return group->layer_ > current_layer; });
 
-  if (!available_groups.empty())
+  if (!available_groups_.empty())
   {
-    return pick_random(begin(available_groups), end(available_groups));
+    return pick_random(begin(available_groups_), end(available_groups_));
   }
   return {};
 }
 
+// Picks a random group among the available ones with the best free capacity,
+// found in a single pass.
+template <typename Compare>
+std::optional<Group *>
+OverflowPolicy::pick_best(const Load &load, Compare compare)
+{
+  const auto &available_groups = get_available_groups(load, group_->layer_);
+  if (available_groups.empty())
+  {
+    return fallback_policy();
+  }
+
+  // The best groups are moved to the front of the scratch buffer
+  size_t best_count = 0;
+  for (auto *group : available_groups_)
+  {
+    if (best_count != 0)
+    {
+      const auto &best_free_capacity = available_groups_.front()->free_capacity();
+      if (compare(best_free_capacity, group->free_capacity()))
+      {
+        continue;
+      }
+      if (compare(group->free_capacity(), best_free_capacity))
+      {
+        best_count = 0;
+      }
+    }
+    available_groups_[best_count++] = group;
+  }
+  return pick_random(
+      begin(available_groups_), begin(available_groups_) + static_cast<ptrdiff_t>(best_count));
+}
+
 //----------------------------------------------------------------------
 std::optional<Group *>
 NoOverflow::find_next_group(const Load & /* load */)
@@ -87,10 +110,9 @@ FirstAvailable::find_next_group(const Load &load)
 {
   for (const auto &next_group : group_->next_groups_)
   {
-    if (std::find(std::begin(load.served_by), std::end(load.served_by), next_group)
-        == std::end(load.served_by))
+    if (!load.served_by.contains(next_group->index_))
     {
-      if (auto [is_served, compression, bucket] = next_group->can_serve(load.tc_id); is_served)
+      if (auto [is_served, compression, bucket] = next_group->can_serve(load.tc_index); is_served)
       {
         std::ignore = compression;
         return next_group;
@@ -106,8 +128,7 @@ AlwaysFirst::find_next_group(const Load &load)
 {
   for (const auto &next_group : group_->next_groups_)
   {
-    if (std::find(std::begin(load.served_by), std::end(load.served_by), next_group)
-        == std::end(load.served_by))
+    if (!load.served_by.contains(next_group->index_))
     {
       return next_group;
     }
@@ -121,8 +142,7 @@ OverflowPolicy::find_next_group(const Load &load)
 {
   for (const auto &next_group : group_->next_groups_)
   {
-    if (std::find(std::begin(load.served_by), std::end(load.served_by), next_group)
-        == std::end(load.served_by))
+    if (!load.served_by.contains(next_group->index_))
     {
       return next_group;
     }
@@ -134,7 +154,7 @@ OverflowPolicy::find_next_group(const Load &load)
 std::optional<Group *>
 RandomAvailable::find_next_group(const Load &load)
 {
-  auto available_groups = get_available_groups(load, group_->layer_);
+  const auto &available_groups = get_available_groups(load, group_->layer_);
 
   if (!available_groups.empty())
   {
@@ -151,50 +171,13 @@ RandomAvailable::find_next_group(const Load &load)
 std::optional<Group *>
 HighestFreeCapacity::find_next_group(const Load &load)
 {
-  auto available_groups = get_available_groups(load, group_->layer_);
-
-  if (!available_groups.empty())
-  {
-    sort(
-        begin(available_groups),
-        end(available_groups),
-        [](const auto &group_ptr1, const auto &group_ptr2) {
-          return group_ptr1->free_capacity() > group_ptr2->free_capacity();
-        });
-
-    auto &g1 = available_groups.front();
-    auto  end_of_equal_groups_it =
-        std::find_if_not(next(begin(available_groups)), end(available_groups), [g1](auto &g2) {
-          return g1->free_capacity() == g2->free_capacity();
-        });
-
-    return pick_random(begin(available_groups), end_of_equal_groups_it);
-  }
-  return fallback_policy();
+  return pick_best(load, std::greater<>{});
 }
 //----------------------------------------------------------------------
 std::optional<Group *>
 LowestFreeCapacity::find_next_group(const Load &load)
 {
-  auto available_groups = get_available_groups(load, group_->layer_);
-
-  if (!available_groups.empty())
-  {
-    sort(
-        begin(available_groups),
-        end(available_groups),
-        [](const auto &group_ptr1, const auto &group_ptr2) {
-          return group_ptr1->free_capacity() < group_ptr2->free_capacity();
-        });
-
-    auto &g1 = available_groups.front();
-    auto  end_of_equal_groups_it =
-        std::find_if_not(next(begin(available_groups)), end(available_groups), [g1](auto &g2) {
-          return g1->free_capacity() == g2->free_capacity();
-        });
-    return pick_random(begin(available_groups), end_of_equal_groups_it);
-  }
-  return fallback_policy();
+  return pick_best(load, std::less<>{});
 }
 
 } // namespace Simulation
@@ -29,11 +29,16 @@ protected:
   World *world_ = nullptr;
 
   // TODO(PW): extract it to scenario settings
-  static constexpr int             overflows_per_layer = 2;
-  std::array<int, MaxLayersNumber> count_layers_usage(const Path &path) const;
+  static constexpr int overflows_per_layer = 2;
 
-  std::optional<Group *> fallback_policy();
-  std::vector<Group *>   get_available_groups(const Load &load, Layer layer);
+  // Scratch buffer for the candidate groups, reused between the calls.
+  std::vector<Group *> available_groups_{};
+
+  std::optional<Group *>      fallback_policy();
+  const std::vector<Group *> &get_available_groups(const Load &load, Layer layer);
+
+  template <typename Compare>
+  std::optional<Group *> pick_best(const Load &load, Compare compare);
 
   template <typename BeginIt, typename EndIt>
   Group *pick_random(BeginIt &&begin, EndIt &&end);
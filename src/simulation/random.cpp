@@ -0,0 +1,65 @@
+#include "random.h"
+
+namespace Simulation {
+
+static constexpr uint32_t philox_m0 = 0xD2511F53;
+static constexpr uint32_t philox_m1 = 0xCD9E8D57;
+static constexpr uint32_t philox_w0 = 0x9E3779B9;
+static constexpr uint32_t philox_w1 = 0xBB67AE85;
+static constexpr int      philox_rounds = 10;
+
+Philox::Philox(uint64_t key, uint64_t stream)
+  : key_{static_cast<uint32_t>(key), static_cast<uint32_t>(key >> 32)},
+    counter_{0, 0, static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)}
+{
+}
+
+Philox::Counter
+Philox::block(Counter counter, Key key)
+{
+  for (int round = 0; round < philox_rounds; ++round)
+  {
+    const auto p0 = uint64_t{philox_m0} * counter[0];
+    const auto p1 = uint64_t{philox_m1} * counter[2];
+    counter = {
+        static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ key[0],
+        static_cast<uint32_t>(p1),
+        static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ key[1],
+        static_cast<uint32_t>(p0)};
+    key[0] += philox_w0;
+    key[1] += philox_w1;
+  }
+  return counter;
+}
+
+void
+Philox::refill()
+{
+  const auto output = block(counter_, key_);
+  buffer_[0] = uint64_t{output[0]} | uint64_t{output[1]} << 32;
+  buffer_[1] = uint64_t{output[2]} | uint64_t{output[3]} << 32;
+  index_ = 0;
+
+  if (++counter_[0] == 0)
+  {
+    ++counter_[1];
+  }
+}
+
+// splitmix64 finalizer (S. Vigna), spreads the bits of the seed.
+static uint64_t
+mix(uint64_t value)
+{
+  value += 0x9E3779B97F4A7C15;
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+  return value ^ (value >> 31);
+}
+
+uint64_t
+replication_key(uint64_t seed, uint64_t scenario_index, uint64_t replication)
+{
+  return mix(seed) ^ (scenario_index << 32 | (replication & 0xFFFFFFFF));
+}
+
+} // namespace Simulation
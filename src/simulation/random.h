@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace Simulation {
+
+// Philox4x32-10 counter-based generator (J. K. Salmon et al., "Parallel random numbers: as easy as
+// 1, 2, 3", 2011). A block of the output is a bijection of the counter parametrized by the key, so
+// the streams which differ in the key or in the stream part of the counter never overlap and each
+// of them is created without generating the others.
+//
+// The counter consists of the number of the block (low 64 bits) and the number of the stream
+// (high 64 bits).
+class Philox
+{
+public:
+  using result_type = uint64_t;
+  using Counter = std::array<uint32_t, 4>;
+  using Key = std::array<uint32_t, 2>;
+
+  Philox() : Philox(0, 0) {}
+  Philox(uint64_t key, uint64_t stream);
+
+  static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  result_type operator()()
+  {
+    if (index_ == buffer_.size())
+    {
+      refill();
+    }
+    return buffer_[index_++];
+  }
+
+  static Counter block(Counter counter, Key key);
+
+private:
+  Key                     key_;
+  Counter                 counter_;
+  std::array<uint64_t, 2> buffer_{};
+  size_t                  index_ = buffer_.size();
+
+  void refill();
+};
+
+// Key of the streams of a single replication of a scenario. For a given seed the keys of different
+// (scenario, replication) pairs are different as long as both numbers fit in 32 bits.
+uint64_t replication_key(uint64_t seed, uint64_t scenario_index, uint64_t replication);
+
+} // namespace Simulation
@@ -59,11 +59,11 @@ EngsetSourceStream::init()
   }
 }
 
-std::unique_ptr<ProduceServiceRequestEvent>
+PooledEventPtr<ProduceServiceRequestEvent>
 EngsetSourceStream::create_produce_service_request(Time time)
 {
-  Duration dt{exponential(world_->get_random_engine())};
-  return std::make_unique<ProduceServiceRequestEvent>(world_->get_uuid(), time + dt, this);
+  Duration dt{exponential(random_engine_, exponential_type_)};
+  return world_->make_event<ProduceServiceRequestEvent>(world_->get_uuid(), time + dt, this);
 }
 
 EventPtr
@@ -71,11 +71,11 @@ EngsetSourceStream::create_request(Time time)
 {
   if (pause_)
   {
-    return std::make_unique<Event>(EventType::None, world_->get_uuid(), time);
+    return world_->make_event<Event>(EventType::None, world_->get_uuid(), time);
   }
 
   auto load = create_load(time, tc_.size);
-  return std::make_unique<LoadServiceRequestEvent>(world_->get_uuid(), load);
+  return world_->make_event<LoadServiceRequestEvent>(world_->get_uuid(), load);
 }
 
 //----------------------------------------------------------------------
@@ -3,7 +3,6 @@
 #include "source_stream.h"
 
 #include <fmt/format.h>
-#include <random>
 
 namespace Simulation {
 class EngsetSourceStream : public SourceStream
@@ -11,10 +10,9 @@ class EngsetSourceStream : public SourceStream
   Count sources_number_;
   Count active_sources_{0};
 
-  std::exponential_distribution<time_type<>> exponential{
-      ts::get(tc_.source_intensity / sources_number_)};
+  ExponentialSampler exponential{ts::get(tc_.source_intensity / sources_number_)};
 
-  std::unique_ptr<ProduceServiceRequestEvent> create_produce_service_request(Time time);
+  PooledEventPtr<ProduceServiceRequestEvent> create_produce_service_request(Time time);
 
   template <typename T, typename Char, typename Enable>
   friend struct fmt::formatter;
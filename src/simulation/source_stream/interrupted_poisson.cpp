@@ -0,0 +1,75 @@
+
+#include "interrupted_poisson.h"
+
+#include "simulation/group.h"
+#include "simulation/load_format.h"
+#include "simulation/source_stream/source_stream_format.h"
+#include "simulation/world.h"
+#include "types/types_format.h"
+
+namespace Simulation {
+InterruptedPoissonSourceStream::InterruptedPoissonSourceStream(
+    const SourceName &  name,
+    const TrafficClass &tc,
+    Intensity           on_intensity,
+    Intensity           on_to_off_intensity,
+    Intensity           off_to_on_intensity)
+  : SourceStream(name, tc),
+    arrival_(ts::get(on_intensity)),
+    on_duration_(ts::get(on_to_off_intensity)),
+    off_duration_(ts::get(off_to_on_intensity)),
+    on_probability_(static_cast<double>(
+        ts::get(off_to_on_intensity)
+        / (ts::get(on_to_off_intensity) + ts::get(off_to_on_intensity))))
+{
+}
+
+void
+InterruptedPoissonSourceStream::notify_on_request_service_start(
+    const LoadServiceRequestEvent *event)
+{
+  world_->schedule(create_request(event->load.send_time));
+}
+
+void
+InterruptedPoissonSourceStream::init()
+{
+  on_ = ZigguratExponential::uniform(random_engine_) < on_probability_;
+  world_->schedule(create_request(world_->get_time()));
+}
+
+// Both phases are memoryless, so the time to the next arrival and the time to
+// the end of the ON phase are drawn anew after each arrival. The stream is
+// fitted for a single load point, so it is not thinned in a coupled sweep.
+EventPtr
+InterruptedPoissonSourceStream::create_request(Time time)
+{
+  if (pause_)
+  {
+    return world_->make_event<Event>(EventType::None, world_->get_uuid(), time);
+  }
+  Duration dt{0};
+  for (;;)
+  {
+    if (!on_)
+    {
+      dt += Duration{off_duration_(random_engine_, exponential_type_)};
+      on_ = true;
+    }
+    const auto arrival = arrival_(random_engine_, exponential_type_);
+    const auto on_left = on_duration_(random_engine_, exponential_type_);
+    if (arrival <= on_left)
+    {
+      dt += Duration{arrival};
+      break;
+    }
+    dt += Duration{on_left};
+    on_ = false;
+  }
+  auto load = create_load(time + dt, tc_.size);
+  debug_print("{} Produced: {}\n", *this, load);
+
+  return world_->make_event<LoadServiceRequestEvent>(world_->get_uuid(), load);
+}
+
+} // namespace Simulation
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "source_stream.h"
+
+namespace Simulation {
+// Interrupted Poisson process (A. Kuczura, 1973): the requests arrive with the
+// given intensity in the ON phase only. The phases alternate after exponential
+// times. Stands for the overflow traffic of a group which is not simulated.
+class InterruptedPoissonSourceStream : public SourceStream
+{
+  ExponentialSampler arrival_;
+  ExponentialSampler on_duration_;
+  ExponentialSampler off_duration_;
+  double             on_probability_;
+  bool               on_ = true;
+
+  EventPtr create_request(Time time);
+
+public:
+  InterruptedPoissonSourceStream(
+      const SourceName &name,
+      const TrafficClass &tc,
+      Intensity           on_intensity,
+      Intensity           on_to_off_intensity,
+      Intensity           off_to_on_intensity);
+
+  void init() override;
+  void notify_on_request_service_start(const LoadServiceRequestEvent *event) override;
+};
+
+} // namespace Simulation
@@ -120,7 +120,7 @@ PascalSourceStream::notify_on_request_service_end(const LoadServiceEndEvent *eve
         *linked_event_it->second,
         *event,
         event->load.id);
-    linked_event_it->second->skip_event();
+    world_->cancel(*linked_event_it->second);
   }
   linked_sources_.erase(linked_event_range_it.first, linked_event_range_it.second);
   debug_print("{} Load has been served {}\n", *this, event->load);
@@ -142,13 +142,13 @@ PascalSourceStream::notify_on_produce(const ProduceServiceRequestEvent *event)
         *new_event,
         it.value()->first);
 
-    it.value()->second->skip_event();
-    linked_sources_.erase(it.value());
+    // The linked event is the one being processed, so only the link is removed
     debug_print(
         "{} [on produce] Remove event {} linked to load id {}\n",
         *this,
         *it.value()->second,
         it.value()->first);
+    linked_sources_.erase(it.value());
   }
 
   world_->schedule(std::move(new_event));
@@ -163,11 +163,11 @@ PascalSourceStream::init()
   }
 }
 
-std::unique_ptr<ProduceServiceRequestEvent>
+PooledEventPtr<ProduceServiceRequestEvent>
 PascalSourceStream::create_produce_service_request(Time time)
 {
-  Duration dt{exponential(world_->get_random_engine())};
-  return std::make_unique<ProduceServiceRequestEvent>(world_->get_uuid(), time + dt, this);
+  Duration dt{exponential(random_engine_, exponential_type_)};
+  return world_->make_event<ProduceServiceRequestEvent>(world_->get_uuid(), time + dt, this);
 }
 
 EventPtr
@@ -175,14 +175,14 @@ PascalSourceStream::create_request(Time time)
 {
   if (pause_)
   {
-    return std::make_unique<Event>(EventType::None, world_->get_uuid(), time);
+    return world_->make_event<Event>(EventType::None, world_->get_uuid(), time);
   }
 
-  // Duration dt{exponential(world_->get_random_engine())};
+  // Duration dt{exponential(random_engine_)};
   auto load = create_load(time, tc_.size);
   debug_print("{} Produced: {}\n", *this, load);
 
-  return std::make_unique<LoadServiceRequestEvent>(world_->get_uuid(), load);
+  return world_->make_event<LoadServiceRequestEvent>(world_->get_uuid(), load);
 }
 
 //----------------------------------------------------------------------
@@ -4,7 +4,6 @@
 #include "source_stream.h"
 #include "types/hash.h"
 
-#include <random>
 #include <unordered_map>
 
 namespace Simulation {
@@ -16,10 +15,9 @@ class PascalSourceStream : public SourceStream
   Count                                    linked_sources_count_{0};
   std::unordered_multimap<LoadId, Event *> linked_sources_{};
 
-  std::exponential_distribution<time_type<>> exponential{
-      ts::get(tc_.source_intensity / sources_number_)};
+  ExponentialSampler exponential{ts::get(tc_.source_intensity / sources_number_)};
 
-  std::unique_ptr<ProduceServiceRequestEvent> create_produce_service_request(Time time);
+  PooledEventPtr<ProduceServiceRequestEvent> create_produce_service_request(Time time);
 
   template <typename T, typename Char, typename Enable>
   friend struct fmt::formatter;
@@ -30,13 +30,33 @@ PoissonSourceStream::create_request(Time time)
 {
   if (pause_)
   {
-    return std::make_unique<Event>(EventType::None, world_->get_uuid(), time);
+    return world_->make_event<Event>(EventType::None, world_->get_uuid(), time);
   }
-  Duration dt{exponential(world_->get_random_engine())};
-  auto     load = create_load(time + dt, tc_.size);
+  auto load = create_load(time + draw_interarrival_time(), tc_.size);
   debug_print("{} Produced: {}\n", *this, load);
 
-  return std::make_unique<LoadServiceRequestEvent>(world_->get_uuid(), load);
+  return world_->make_event<LoadServiceRequestEvent>(world_->get_uuid(), load);
+}
+
+Load
+PoissonSourceStream::produce_next_load(Time time)
+{
+  return create_load(time + draw_interarrival_time(), tc_.size);
+}
+
+Duration
+PoissonSourceStream::draw_interarrival_time()
+{
+  if (!thinning_)
+  {
+    return Duration{exponential(random_engine_, exponential_type_)};
+  }
+  Duration dt{0};
+  do
+  {
+    dt += Duration{*thinning_ * exponential(random_engine_, exponential_type_)};
+  } while (ZigguratExponential::uniform(random_engine_) >= *thinning_);
+  return dt;
 }
 
 } // namespace Simulation
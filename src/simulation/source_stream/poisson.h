@@ -2,19 +2,22 @@
 
 #include "source_stream.h"
 
-#include <random>
-
 namespace Simulation {
 class PoissonSourceStream : public SourceStream
 
 {
-  std::exponential_distribution<time_type<>> exponential{ts::get(tc_.source_intensity)};
+  ExponentialSampler exponential{ts::get(tc_.source_intensity)};
 
   EventPtr create_request(Time time);
+  Duration draw_interarrival_time();
 
 public:
   PoissonSourceStream(const SourceName &name, const TrafficClass &tc);
 
+  // The load following the one sent at the given time, produced outside of the events (see
+  // World::run_states()) from the same stream as the requests of the event-driven run.
+  Load produce_next_load(Time time);
+
   void init() override;
   void notify_on_request_service_start(const LoadServiceRequestEvent *event) override;
 };
@@ -18,10 +18,11 @@ SourceStream::create_load(Time time, Size size)
   Load load;
   load.id = LoadId{world_->get_uuid()};
   load.tc_id = tc_.id;
+  load.tc_index = static_cast<uint32_t>(tc_index_);
   load.send_time = time;
   load.size = size;
-  load.produced_by = this;
-  load.target_group = target_group_;
+  load.produced_by = index_;
+  load.target_group = target_group_->index_;
   return load;
 }
 
@@ -65,6 +66,8 @@ void
 SourceStream::set_world(World &world)
 {
   world_ = &world;
+  random_engine_ = world.make_random_engine(ts::get(id));
+  exponential_type_ = world.get_exponential_sampler();
 }
 
 void
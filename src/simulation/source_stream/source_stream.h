@@ -1,11 +1,14 @@
 #pragma once
 
 #include "simulation/event.h"
+#include "simulation/exponential.h"
+#include "simulation/random.h"
 #include "traffic_class.h"
 #include "types/types.h"
 
 #include <fmt/format.h>
 #include <memory>
+#include <optional>
 namespace Simulation {
 class World;
 struct Group;
@@ -19,9 +22,15 @@ public:
 
 protected:
   World *world_ = nullptr;
+  Philox  random_engine_{};
+
+  ExponentialSamplerType exponential_type_{};
+  std::optional<double>  thinning_{};
 
   Group *target_group_ = nullptr;
 
+  uint32_t index_{0}; // see Topology::compile()
+  size_t   tc_index_{0};
   bool     pause_ = false;
   uint64_t loads_produced_{0};
 
@@ -46,9 +55,18 @@ public:
 
   void set_world(World &world);
   void attach_to_group(Group &target_group);
+  void set_index(uint32_t index) { index_ = index; }
+  void set_traffic_class_index(size_t tc_index) { tc_index_ = tc_index; }
+  // Only the accepted fraction of the candidate arrivals is offered. Every candidate draws its
+  // acceptance, also at the thinning 1, so the sources of all the points of the sweep consume
+  // their streams in the same way. This is only the common random numbers of the sweep, a source
+  // at the thinning p draws 1/p candidates and as many uniforms per offered arrival.
+  void set_thinning(double thinning) { thinning_ = thinning; }
+
   void pause() { pause_ = true; }
 
   const SourceName &get_name() { return name_; }
+  uint64_t          loads_produced() const { return loads_produced_; }
   const Group &     get_target_group() { return *target_group_; }
 
   void print_stats();
@@ -2,6 +2,11 @@
 
 #include "math_utils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
 namespace Simulation {
 //----------------------------------------------------------------------
 
@@ -60,6 +65,26 @@ BlockStats::try_unblock(const Time &time)
   }
   return false;
 }
+
+Duration
+BlockStats::block_time_until(const Time &time) const
+{
+  if (is_blocked)
+  {
+    return block_time + (time - start_of_block);
+  }
+  return block_time;
+}
+
+void
+BlockStats::reset(const Time &time)
+{
+  block_time = Duration{0};
+  if (is_blocked)
+  {
+    start_of_block = time;
+  }
+}
 //----------------------------------------------------------------------
 
 void
@@ -80,15 +105,15 @@ LostServedStats::serve(const Load &load)
 }
 
 void
-LostServedStats::drop(const Load &load)
+LostServedStats::drop(Size size)
 {
-  lost.size += load.size;
+  lost.size += size;
   lost.count++;
 }
 void
-LostServedStats::forward(const Load &load)
+LostServedStats::forward(Size size)
 {
-  forwarded.size += load.size;
+  forwarded.size += size;
   forwarded.count++;
 }
 
@@ -127,26 +152,242 @@ TrafficClassStats::forward_ratio_u() const
       get(lost_served_stats.lost.count));
 }
 //----------------------------------------------------------------------
+void
+GroupStatistics::set_traffic_classes(std::vector<TrafficClassId> ids)
+{
+  tc_ids = std::move(ids);
+  served_by_tc.resize(tc_ids.size());
+  blocked_by_tc.resize(tc_ids.size());
+  blocked_recursive_by_tc.resize(tc_ids.size());
+}
+
+void
+GroupStatistics::reset(const Time &time)
+{
+  std::fill(begin(served_by_tc), end(served_by_tc), LostServedStats{});
+  for (auto &block_stats : blocked_by_tc)
+  {
+    block_stats.reset(time);
+  }
+  for (auto &block_stats : blocked_recursive_by_tc)
+  {
+    block_stats.reset(time);
+  }
+  occupancy_area = 0.0L;
+  occupancy_since = time;
+}
+
+void
+GroupStatistics::add_occupancy(long double occupancy, const Time &time)
+{
+  occupancy_area = occupancy_area_until(occupancy, time);
+  occupancy_since = time;
+}
+
+long double
+GroupStatistics::occupancy_area_until(long double occupancy, const Time &time) const
+{
+  return occupancy_area + occupancy * ts::get(time - occupancy_since);
+}
+
 Stats
 GroupStatistics::get_stats(Duration sim_duration)
 {
   Stats stats;
 
-  for (auto &[tc_id, load_stats] : served_by_tc)
+  for (size_t tc_index = 0; tc_index < tc_ids.size(); ++tc_index)
   {
-    std::ignore = load_stats;
-    auto &serve_stats = served_by_tc[tc_id];
+    const auto &serve_stats = served_by_tc[tc_index];
     if (serve_stats.lost.count == Count{0}
         && serve_stats.served.count == Count{0})
       continue;
-    stats.by_traffic_class[tc_id] = {
+    stats.by_traffic_class[tc_ids[tc_index]] = {
         {serve_stats.lost, serve_stats.served, serve_stats.forwarded},
-        blocked_by_tc[tc_id].block_time,
-        blocked_recursive_by_tc[tc_id].block_time,
+        blocked_by_tc[tc_index].block_time,
+        blocked_recursive_by_tc[tc_index].block_time,
         sim_duration};
     stats.total += serve_stats;
   }
   return stats;
 }
 
+//----------------------------------------------------------------------
+double
+BatchMeans::mean() const
+{
+  if (values.empty())
+  {
+    return 0.0;
+  }
+  return std::accumulate(begin(values), end(values), 0.0) / static_cast<double>(values.size());
+}
+
+double
+BatchMeans::half_width() const
+{
+  if (values.size() < 2)
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+  const auto m = mean();
+  double     sum_of_squares = 0.0;
+  for (auto value : values)
+  {
+    sum_of_squares += (value - m) * (value - m);
+  }
+  const auto n = static_cast<double>(values.size());
+  const auto variance = sum_of_squares / (n - 1.0);
+  return Math::student_t_95(values.size() - 1) * std::sqrt(variance / n);
+}
+
+double
+BatchMeans::relative_half_width() const
+{
+  const auto m = mean();
+  if (m <= 0.0)
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+  return half_width() / m;
+}
+
+//----------------------------------------------------------------------
+std::optional<ControlVariateEstimate>
+control_variate_estimate(
+    const std::vector<double> &values, const std::vector<std::vector<double>> &controls)
+{
+  const auto n = values.size();
+  const auto q = controls.empty() ? 0 : controls.front().size();
+  if (n < q + 3 || controls.size() != n
+      || std::any_of(begin(controls), end(controls), [q](const auto &row) {
+           return row.size() != q;
+         }))
+  {
+    return std::nullopt;
+  }
+
+  // Normal equations of the regression on [1, controls], solved together for
+  // the coefficients and for the first column of the inverse, which scales the
+  // variance of the intercept.
+  const auto                       m = q + 1;
+  std::vector<std::vector<double>> a(m, std::vector<double>(m + 2, 0.0));
+  for (size_t k = 0; k < n; ++k)
+  {
+    for (size_t i = 0; i < m; ++i)
+    {
+      const auto z_i = i == 0 ? 1.0 : controls[k][i - 1];
+      for (size_t j = 0; j < m; ++j)
+      {
+        a[i][j] += z_i * (j == 0 ? 1.0 : controls[k][j - 1]);
+      }
+      a[i][m] += z_i * values[k];
+    }
+  }
+  a[0][m + 1] = 1.0;
+
+  double scale = 0.0;
+  for (size_t i = 0; i < m; ++i)
+  {
+    scale = std::max(scale, std::abs(a[i][i]));
+  }
+  for (size_t column = 0; column < m; ++column)
+  {
+    auto pivot = column;
+    for (size_t row = column + 1; row < m; ++row)
+    {
+      if (std::abs(a[row][column]) > std::abs(a[pivot][column]))
+      {
+        pivot = row;
+      }
+    }
+    if (std::abs(a[pivot][column]) <= 1e-12 * scale)
+    {
+      return std::nullopt;
+    }
+    std::swap(a[pivot], a[column]);
+    for (size_t row = 0; row < m; ++row)
+    {
+      if (row == column)
+      {
+        continue;
+      }
+      const auto factor = a[row][column] / a[column][column];
+      for (size_t j = column; j < m + 2; ++j)
+      {
+        a[row][j] -= factor * a[column][j];
+      }
+    }
+  }
+
+  double residual_sum_of_squares = 0.0;
+  double sum = 0.0;
+  double sum_of_squares = 0.0;
+  for (size_t k = 0; k < n; ++k)
+  {
+    auto fitted = a[0][m] / a[0][0];
+    for (size_t j = 1; j < m; ++j)
+    {
+      fitted += a[j][m] / a[j][j] * controls[k][j - 1];
+    }
+    residual_sum_of_squares += (values[k] - fitted) * (values[k] - fitted);
+    sum += values[k];
+    sum_of_squares += values[k] * values[k];
+  }
+
+  const auto n_f = static_cast<double>(n);
+  const auto degrees_of_freedom = n - m;
+  const auto variance = residual_sum_of_squares / static_cast<double>(degrees_of_freedom)
+                        * (a[0][m + 1] / a[0][0]);
+  const auto raw_variance = (sum_of_squares - sum * sum / n_f) / (n_f - 1.0) / n_f;
+
+  ControlVariateEstimate estimate;
+  estimate.mean = a[0][m] / a[0][0];
+  estimate.half_width = Math::student_t_95(degrees_of_freedom) * std::sqrt(variance);
+  estimate.variance_reduction =
+      variance > 0.0 ? raw_variance / variance : std::numeric_limits<double>::infinity();
+  return estimate;
+}
+
+//----------------------------------------------------------------------
+std::optional<size_t>
+mser_truncation(const std::vector<double> &series, size_t batch_size)
+{
+  const auto batches_number = series.size() / batch_size;
+  if (batches_number < 4)
+  {
+    return std::nullopt;
+  }
+  std::vector<double> batches(batches_number);
+  for (size_t j = 0; j < batches_number; ++j)
+  {
+    const auto first = next(begin(series), static_cast<ptrdiff_t>(j * batch_size));
+    batches[j] = std::accumulate(first, next(first, static_cast<ptrdiff_t>(batch_size)), 0.0)
+                 / static_cast<double>(batch_size);
+  }
+
+  // The statistic for every truncation point is computed from the sums over
+  // the tail, accumulated from the end of the series.
+  std::vector<double> statistic(batches_number, std::numeric_limits<double>::infinity());
+  double              sum = 0.0;
+  double              sum_of_squares = 0.0;
+  for (size_t d = batches_number; d-- > 0;)
+  {
+    sum += batches[d];
+    sum_of_squares += batches[d] * batches[d];
+    const auto k = static_cast<double>(batches_number - d);
+    if (k >= 2.0)
+    {
+      statistic[d] = (sum_of_squares - sum * sum / k) / (k * k);
+    }
+  }
+
+  const auto best = static_cast<size_t>(
+      std::distance(begin(statistic), std::min_element(begin(statistic), end(statistic))));
+  if (best > batches_number / 2)
+  {
+    return std::nullopt;
+  }
+  return best * batch_size;
+}
+
 } // namespace Simulation
@@ -5,7 +5,9 @@
 
 #include <boost/container/flat_map.hpp>
 #include <map>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 namespace Simulation {
 
@@ -24,6 +26,12 @@ struct BlockStats
 
   bool try_block(const Time &time);
   bool try_unblock(const Time &time);
+
+  // Block time including the ongoing block.
+  Duration block_time_until(const Time &time) const;
+
+  // Forgets the block time, the ongoing block is counted from the given time.
+  void reset(const Time &time);
 };
 //----------------------------------------------------------------------
 
@@ -34,8 +42,8 @@ struct LostServedStats
   LoadStats forwarded{};
 
   void serve(const Load &load);
-  void drop(const Load &load);
-  void forward(const Load &load);
+  void drop(Size size);
+  void forward(Size size);
 };
 //----------------------------------------------------------------------
 
@@ -65,16 +73,67 @@ struct Stats
 };
 
 //----------------------------------------------------------------------
+// Statistics addressed by the dense index of the traffic class, tc_ids maps
+// the index back to the id for reporting.
 struct GroupStatistics
 {
-  boost::container::flat_map<TrafficClassId, LostServedStats> served_by_tc;
-  boost::container::flat_map<TrafficClassId, BlockStats>      blocked_by_tc;
-  boost::container::flat_map<TrafficClassId, BlockStats>
-      blocked_recursive_by_tc;
+  std::vector<TrafficClassId>  tc_ids{};
+  std::vector<LostServedStats> served_by_tc{};
+  std::vector<BlockStats>      blocked_by_tc{};
+  std::vector<BlockStats>      blocked_recursive_by_tc{};
+
+  // Time integral of the occupancy of the group, in the capacity units.
+  long double occupancy_area = 0.0L;
+  Time        occupancy_since{0};
+
+  // The occupancy held since occupancy_since changes at the given time.
+  void        add_occupancy(long double occupancy, const Time &time);
+  long double occupancy_area_until(long double occupancy, const Time &time) const;
 
+  void  set_traffic_classes(std::vector<TrafficClassId> ids);
+  void  reset(const Time &time);
   Stats get_stats(Duration sim_duration);
 };
 
+//----------------------------------------------------------------------
+// Means of the consecutive batches of a single run. The batches are long
+// enough to be treated as independent, so their spread gives the confidence
+// interval of the estimate.
+struct BatchMeans
+{
+  std::vector<double> values{};
+
+  void   add(double value) { values.push_back(value); }
+  size_t size() const { return values.size(); }
+  double mean() const;
+  double half_width() const;          // of the 95% confidence interval
+  double relative_half_width() const; // half_width() / mean()
+};
+
+//----------------------------------------------------------------------
+// Control-variate estimate of the mean of the batch values (S. S. Lavenberg and
+// P. D. Welch, 1981). Every batch value comes with the values of the controls in
+// that batch, centred at their known means. The estimate is the intercept of the
+// least-squares regression of the values on the controls. No estimate is given
+// for fewer than controls + 3 batches or for linearly dependent controls.
+struct ControlVariateEstimate
+{
+  double mean = 0.0;
+  double half_width = 0.0;         // of the 95% confidence interval
+  double variance_reduction = 1.0; // variance of the mean of the values / of the estimate
+};
+
+std::optional<ControlVariateEstimate> control_variate_estimate(
+    const std::vector<double> &values, const std::vector<std::vector<double>> &controls);
+
+//----------------------------------------------------------------------
+// MSER-m truncation point of the series (K. P. White, 1997): the number of the
+// initial observations whose deletion minimizes the standard error of the mean
+// of the rest. The observations are averaged in batches of batch_size. No value
+// is returned when the truncation point lies in the second half of the series,
+// i.e. the series has not reached the steady state yet.
+std::optional<size_t> mser_truncation(const std::vector<double> &series, size_t batch_size = 5);
+
 //----------------------------------------------------------------------
 LoadStats       operator+(const LoadStats &s1, const LoadStats &s2);
 LoadStats &     operator+=(LoadStats &s1, const LoadStats &s2);
@@ -1,6 +1,6 @@
-
 #include "world.h"
 
+#include "event_set/factory.h"
 #include "group.h"
 #include "load.h"
 #include "load_format.h"
@@ -11,11 +11,37 @@
 #include "source_stream/source_stream_format.h"
 #include "types/types_format.h"
 
+#include <algorithm>
+#include <fmt/ranges.h>
 #include <nlohmann/json.hpp>
 
 namespace Simulation {
 
-World::World(uint64_t seed, Duration duration) : seed_(seed), duration_(duration)
+// Control-variate estimate of a quantity next to its raw value, null if there is none.
+static void
+append_control_variate(
+    nlohmann::json &                        j_tc,
+    const std::string &                     name,
+    const std::vector<double> &             values,
+    const std::vector<std::vector<double>> &controls)
+{
+  const auto estimate = control_variate_estimate(values, controls);
+  j_tc[name + "_cv"].push_back(estimate ? nlohmann::json(estimate->mean) : nlohmann::json());
+  j_tc[name + "_cv_hw"].push_back(
+      estimate ? nlohmann::json(estimate->half_width) : nlohmann::json());
+  j_tc[name + "_vrf"].push_back(
+      estimate ? nlohmann::json(estimate->variance_reduction) : nlohmann::json());
+}
+
+World::World(
+    uint64_t               seed,
+    Duration               duration,
+    EventSetType           event_set_type,
+    ExponentialSamplerType exponential_sampler)
+  : seed_(seed),
+    duration_(duration),
+    events_(make_event_set(event_set_type)),
+    exponential_sampler_(exponential_sampler)
 {
   // print("[World] {:=^100}\n", " New world ");
 }
@@ -33,6 +59,8 @@ World::init()
     std::ignore = id;
     blocked_by_size.emplace(tc.size, BlockStats{});
   }
+  in_warmup_ = warmup_detection_.enabled || epochs_.warmup > 0;
+  next_detection_ = warmup_detection_.min_samples;
 }
 
 bool
@@ -40,47 +68,99 @@ World::next_iteration()
 {
   debug_print("{} Time = {:*<80}\n", *this, time_);
 
+  discard_cancelled_events();
   Time next_event{0};
-  if (!events_.empty())
+  if (!events_->empty())
   {
-    next_event = events_.top()->time;
+    next_event = events_->top()->time;
   }
+  advance_time(next_event);
 
+  process_event();
+  return time_ <= finish_time_ || !events_->empty();
+}
+
+void
+World::advance_time(Time next_event)
+{
   time_ += tick_length_;
 
   time_ = std::max(next_event, time_);
+  on_time_advanced();
+}
+
+void
+World::on_time_advanced()
+{
+  if (warmup_detection_.enabled && in_warmup_ && time_ <= finish_time_ && time_ >= next_sample_)
+  {
+    sample_occupancy();
+  }
+
+  if (epochs_.enabled() && !stopped_early_ && time_ <= finish_time_
+      && ts::get(time_ - epoch_start_) >= ts::get(epochs_.duration))
+  {
+    end_epoch();
+  }
 
   if (time_ > finish_time_)
   {
-    for (auto &[name, source] : topology_->sources)
-    {
-      std::ignore = name;
-      source->pause();
-    }
+    pause_sources();
   }
+}
 
-  process_event();
-  return time_ <= finish_time_ || !events_.empty();
+void
+World::pause_sources()
+{
+  for (auto &[name, source] : topology_->sources)
+  {
+    std::ignore = name;
+    source->pause();
+  }
 }
 
 void
 World::process_event()
 {
-  while (!events_.empty() && events_.top()->time <= time_)
+  while (!events_->empty() && events_->top()->time <= time_)
   {
-    auto &event = events_.top();
-    current_time_ = event->time;
-    if (!event->skip)
+    auto event = events_->pop();
+    if (!event->cancelled)
     {
-      debug_print("{} Processing event {}\n", *this, *event);
-      event->process();
+      process(*event);
     }
     else
     {
-      debug_print("{} Event {} is not processed\n", *this, *event);
-      event->skip_notify();
+      skip(*event);
     }
-    events_.pop();
+  }
+}
+
+void
+World::process(Event &event)
+{
+  current_time_ = event.time;
+  debug_print("{} Processing event {}\n", *this, event);
+  visit([this](auto &typed_event) { typed_event.process(*topology_); }, event);
+  ++processed_events_;
+}
+
+void
+World::skip(Event &event)
+{
+  debug_print("{} Event {} is not processed\n", *this, event);
+  visit([this](auto &typed_event) { typed_event.skip_notify(*topology_); }, event);
+  --cancelled_pending_;
+}
+
+// Cancelled events must not determine the time of the next iteration, otherwise the results would
+// depend on when the event set has been compacted.
+void
+World::discard_cancelled_events()
+{
+  while (!events_->empty() && events_->top()->cancelled)
+  {
+    skip(*events_->pop());
   }
 }
 
@@ -90,7 +170,7 @@ World::get_uuid()
   return ++last_id;
 }
 
-std::mt19937_64 &
+World::RandomEngine &
 World::get_random_engine()
 {
   return random_engine_;
@@ -103,7 +183,7 @@ World::append_stats(nlohmann::json &j)
   {
     auto &j_group = j[ts::get(name)];
 
-    const auto &group_stats = group->get_stats(Duration{get_time()});
+    const auto &group_stats = group->get_stats(get_time() - stats_start_);
     for (auto &[tc_id, stats] : group_stats.by_traffic_class)
     {
       auto &j_tc = j_group[std::to_string(ts::get(tc_id))];
@@ -122,8 +202,56 @@ World::append_stats(nlohmann::json &j)
       j_tc["P_forward_u"].push_back(stats.forward_ratio_u());
       j_tc["P_block"].push_back(stats.block_ratio());
       j_tc["P_block_recursive"].push_back(stats.block_recursive_ratio());
+
+      if (auto it = estimates_.find({group.get(), tc_id}); it != end(estimates_))
+      {
+        const auto &estimates = it->second;
+        j_tc["P_loss_hw"].push_back(estimates.loss.half_width());
+        j_tc["P_block_hw"].push_back(estimates.block.half_width());
+        j_tc["P_loss_epochs"].push_back(estimates.loss.values);
+        j_tc["P_block_epochs"].push_back(estimates.block.values);
+        if (control_variates_.enabled)
+        {
+          append_control_variate(j_tc, "P_loss", estimates.loss.values, estimates.loss_controls);
+          append_control_variate(
+              j_tc, "P_block", estimates.block.values, estimates.block_controls);
+        }
+      }
+      if (restart_.enabled() && restart_measured_time_ > 0.0L)
+      {
+        const auto group_index = static_cast<size_t>(
+            std::find(begin(chain_.groups), end(chain_.groups), group.get())
+            - begin(chain_.groups));
+        const auto tc_index = static_cast<size_t>(
+            std::find(begin(group->stats_.tc_ids), end(group->stats_.tc_ids), tc_id)
+            - begin(group->stats_.tc_ids));
+        j_tc["P_block_restart"].push_back(
+            restart_block_total_[group_index][tc_index]
+            / static_cast<double>(restart_measured_time_));
+        j_tc["P_block_restart_hw"].push_back(restart_block_[group_index][tc_index].half_width());
+      }
     }
   }
+
+  auto &j_events = j["_events"];
+  j_events["processed"].push_back(processed_events_);
+  j_events["cancelled"].push_back(cancelled_events_);
+  j_events["compactions"].push_back(compactions_);
+  j_events["finish_time"].push_back(ts::get(finish_time_));
+  j_events["stats_start"].push_back(ts::get(stats_start_));
+  j_events["epochs"].push_back(epoch_);
+  j_events["state_based"].push_back(state_based_);
+  j_events["leaps"].push_back(leaps_);
+  j_events["run_time"].push_back(run_time_.count());
+  if (restart_.enabled())
+  {
+    j_events["restart_splits"].push_back(restart_splits_);
+  }
+  if (warmup_detection_.enabled)
+  {
+    j_events["truncation_point"].push_back(
+        truncation_point_ ? nlohmann::json(ts::get(*truncation_point_)) : nlohmann::json());
+  }
   return j;
 }
 nlohmann::json
@@ -137,11 +265,66 @@ void
 World::print_stats()
 {
   print("{} Time = {}\n", *this, time_);
-  print("{} In queue left {} events\n", *this, events_.size());
+  print("{} In queue left {} events\n", *this, events_->size());
+  if (state_based_)
+  {
+    print("{} State-based run, events are the transitions of the Markov chain\n", *this);
+    if (leaps_ > 0)
+    {
+      print("{} Leaps {}, epsilon {}\n", *this, leaps_, leap_settings_.epsilon);
+    }
+    if (restart_.enabled())
+    {
+      print(
+          "{} RESTART thresholds {}, retrials {}, splits {}\n",
+          *this,
+          restart_.thresholds,
+          restart_retrials_,
+          restart_splits_);
+    }
+  }
+  print(
+      "{} Events processed {}, cancelled {} ({} still in queue), compactions {}\n",
+      *this,
+      processed_events_,
+      cancelled_events_,
+      cancelled_pending_,
+      compactions_);
+  if (epochs_.enabled())
+  {
+    print("{} Epochs {}, stats gathered since {}\n", *this, epoch_, stats_start_);
+  }
+  if (warmup_detection_.enabled)
+  {
+    if (truncation_point_)
+    {
+      print(
+          "{} Warm-up detected at {}, truncation point {}\n",
+          *this,
+          stats_start_,
+          *truncation_point_);
+    }
+    else
+    {
+      print("{} Warm-up not detected, stats gathered since the start\n", *this);
+    }
+  }
+  if (stopped_early_)
+  {
+    print("{} Stop condition met at {}\n", *this, finish_time_);
+  }
+  if (run_time_.count() > 0)
+  {
+    print(
+        "{} Run time {:.3f} s, {:.0f} events/s\n",
+        *this,
+        run_time_.count(),
+        static_cast<double>(processed_events_) / run_time_.count());
+  }
   for (auto &[name, group] : topology_->groups)
   {
     std::ignore = name;
-    const auto &group_stats = group->get_stats(Duration{get_time()});
+    const auto &group_stats = group->get_stats(get_time() - stats_start_);
     print("{} {}: {}\n", *this, *group, group_stats);
     for (auto &[tc_id, stats] : group_stats.by_traffic_class)
     {
@@ -160,10 +343,59 @@ World::print_stats()
     std::ignore = source_id;
     source->print_stats();
   }
+
+  for (auto type : EventPool::event_types)
+  {
+    const auto &slab = event_pool_.slab(type);
+    print(
+        "{} Event pool {}: in use {}, high-water mark {}, allocated {} slots\n",
+        *this,
+        type,
+        slab.in_use(),
+        slab.high_water_mark(),
+        slab.capacity());
+  }
+}
+
+void
+World::run(bool quiet, RunMode run_mode)
+{
+  const auto start = std::chrono::steady_clock::now();
+  if (run_mode == RunMode::Auto)
+  {
+    run_mode = can_run_states() ? RunMode::States : RunMode::Events;
+  }
+  ASSERT(
+      !restart_.enabled() || run_mode == RunMode::States,
+      "{} RESTART requires the state-based run",
+      *this);
+  switch (run_mode)
+  {
+    case RunMode::Auto:
+    case RunMode::Events:
+      run_events(quiet);
+      break;
+    case RunMode::Ticks:
+      run_ticks(quiet);
+      break;
+    case RunMode::States:
+      ASSERT(can_run_states(), "{} The topology cannot be simulated by states", *this);
+      run_states(quiet, false);
+      break;
+    case RunMode::Leaps:
+      ASSERT(can_run_states(), "{} The topology cannot be simulated by leaps", *this);
+      run_states(quiet, true);
+      break;
+  }
+  run_time_ = std::chrono::steady_clock::now() - start;
+  if (!quiet)
+  {
+    print_stats();
+  }
 }
 
 void
-World::run(bool quiet)
+World::run_ticks(bool quiet)
 {
   long double stats_freq = 0.25L;
   int         i = 1;
@@ -175,23 +407,96 @@ World::run(bool quiet)
       ++i;
     }
   }
-  if (!quiet)
+}
+
+// Gives the same results as run_ticks(): the clock is advanced by the same rule whenever an event
+// from beyond the current iteration is popped, so the sources are paused at the same moment and the
+// stats cover the same time.
+void
+World::run_events(bool quiet)
+{
+  long double stats_freq = 0.25L;
+  int         i = 1;
+  bool        first_iteration = true;
+  while (time_ <= finish_time_ || !events_->empty())
   {
-    print_stats();
+    if (events_->empty())
+    {
+      advance_time(Time{0});
+      first_iteration = false;
+      continue;
+    }
+
+    auto event = events_->pop();
+    if (event->cancelled)
+    {
+      skip(*event);
+      continue;
+    }
+    if (event->time > time_ || first_iteration)
+    {
+      advance_time(event->time);
+      first_iteration = false;
+    }
+    process(*event);
+
+    if (!quiet && processed_events_ % progress_check_interval_ == 0 &&
+        get_progress() > stats_freq * i)
+    {
+      print_stats();
+      ++i;
+    }
   }
 }
+
 void
 World::set_topology(Topology &topology)
 {
   topology_ = &topology;
   topology_->set_world(*this); // TODO(PW): rethink this relation
+  topology_->compile();
+}
+
+void
+World::set_epochs(const EpochSettings &epochs)
+{
+  epochs_ = epochs;
 }
 
 void
-World::schedule(std::unique_ptr<Event> event)
+World::set_warmup_detection(const WarmupDetection &warmup_detection)
+{
+  warmup_detection_ = warmup_detection;
+}
+
+void
+World::set_stop_condition(const StopCondition &stop_condition)
+{
+  stop_condition_ = stop_condition;
+}
+
+void
+World::schedule(EventPtr event)
 {
   debug_print("{} Scheduled: {}\n", *this, *event);
-  events_.emplace(std::move(event));
+  events_->push(std::move(event));
+}
+
+void
+World::cancel(Event &event)
+{
+  ASSERT(!event.cancelled, "{} Event {} has been already cancelled", *this, event);
+  debug_print("{} Cancelled: {}\n", *this, event);
+  event.cancelled = true;
+  ++cancelled_events_;
+
+  if (++cancelled_pending_ > compaction_min_size_ &&
+      static_cast<double>(cancelled_pending_) >
+          compaction_threshold_ * static_cast<double>(events_->size()))
+  {
+    cancelled_pending_ -= events_->remove_cancelled();
+    ++compactions_;
+  }
 }
 
 } // namespace Simulation
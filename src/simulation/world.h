@@ -1,27 +1,48 @@
 #pragma once
 
+#include "common.h"
 #include "event.h"
+#include "event_pool.h"
+#include "event_set/event_set.h"
 #include "load.h"
+#include "random.h"
 #include "logger.h"
 #include "stats.h"
 #include "topology.h"
 #include "types/hash.h"
 #include "types/types.h"
 
+#include <chrono>
+#include <limits>
+#include <map>
 #include <memory>
-#include <nlohmann/json.hpp>
-#include <queue>
+#include <optional>
 #include <random>
+#include <nlohmann/json.hpp>
+#include <vector>
 
 namespace Simulation {
 
 struct Group;
 class SourceStream;
+class PoissonSourceStream;
+
+// Occupancy and stats of a group in the state-based run, saved and restored around the retrials
+// of RESTART (see World::restart_trial()).
+struct GroupState
+{
+  std::vector<Size>              size{};
+  std::vector<Capacity>          free_capacity{};
+  std::vector<std::vector<Load>> in_service{};
+  GroupStatistics                stats{};
+};
 
 class World
 {
-  using RandomEngine = std::mt19937_64;
+public:
+  using RandomEngine = Philox;
 
+private:
   uint64_t                  seed_;
   Time                      time_{0};
   Duration                  duration_;
@@ -32,33 +53,204 @@ class World
 
   Uuid last_id = 0;
 
-  std::priority_queue<EventPtr, std::vector<EventPtr>, by_time> events_{};
-  RandomEngine                                                  random_engine_{seed_};
+  EventPool                 event_pool_{}; // has to outlive events_
+  std::unique_ptr<EventSet> events_;
+  RandomEngine              random_engine_{seed_, 0}; // stream 0 is not a Uuid
+  ExponentialSamplerType    exponential_sampler_;
+
+  // Departures of the state-based run, the last stream is not a Uuid either.
+  RandomEngine departure_engine_{seed_, std::numeric_limits<Uuid>::max()};
+
+  // Cancelled events are left in the event set until they reach its top, unless they make up more
+  // than the given fraction of it. Then they are removed all at once.
+  static constexpr double compaction_threshold_ = 0.5;
+  static constexpr size_t compaction_min_size_ = 1024;
+
+  size_t   cancelled_pending_ = 0;
+  uint64_t processed_events_ = 0;
+  uint64_t cancelled_events_ = 0;
+  uint64_t compactions_ = 0;
+
+  // Wall-clock time of the whole run, zero until the run is finished.
+  std::chrono::duration<double> run_time_{};
+
+  // Number of processed events between checks of the progress in the event-driven run.
+  static constexpr uint64_t progress_check_interval_ = 1 << 16;
+
+  // Series of the epoch values of a traffic class in a group. The values are computed from the
+  // differences of the cumulative counters of the group since the previous epoch.
+  struct Estimates
+  {
+    LostServedStats previous{};
+    Duration        previous_block_time{0};
+    BatchMeans      loss{};
+    BatchMeans      block{};
+
+    // Values of the control variates in the epochs of loss and block.
+    std::vector<std::vector<double>> loss_controls{};
+    std::vector<std::vector<double>> block_controls{};
+  };
+
+  EpochSettings                                                 epochs_{};
+  StopCondition                                                 stop_condition_{};
+  size_t                                                        epoch_ = 0;
+  Time                                                          epoch_start_{0};
+  Time                                                          stats_start_{0};
+  bool                                                          stopped_early_ = false;
+  bool                                                          state_based_ = false;
+  std::map<std::pair<const Group *, TrafficClassId>, Estimates> estimates_{};
+
+  WarmupDetection     warmup_detection_{};
+  bool                in_warmup_ = false;
+  std::vector<double> occupancy_samples_{};
+  Time                next_sample_{0};
+  size_t              next_detection_ = 0;
+  std::optional<Time> truncation_point_{};
+
+  // Sources and groups of the Markov chain of the system in the state-based run. Every source
+  // keeps its next load pending until the load is sent (see exact_transition()).
+  struct StateChain
+  {
+    std::vector<PoissonSourceStream *> sources{};
+    std::vector<Load>                  next_loads{};
+    std::vector<double>                arrival_rates{};
+    std::vector<Group *>               groups{};
+    std::vector<Load>                  leap_arrivals{};
+
+    // The departures of all the groups are drawn from the total rate of the loads in service, kept
+    // up to date by the groups (see add_departure_rate()).
+    uint64_t                                   loads_in_service = 0;
+    double                                     departure_rate = 0.0;
+    std::exponential_distribution<time_type<>> departure_exponential{};
+  };
+  StateChain chain_{};
+
+  // Groups with the known mean occupancy and the cumulative values of the controls at the end of
+  // the previous epoch.
+  ControlVariates                         control_variates_{};
+  std::vector<std::pair<Group *, double>> control_groups_{};
+  std::vector<long double>                previous_occupancy_area_{};
+  long double                             previous_offered_volume_ = 0.0L;
+
+  LeapSettings leap_settings_{};
+  uint64_t     leaps_ = 0;
+
+  // State of the system at an upward crossing of a RESTART threshold, the retrials start from it.
+  // The pending loads of the sources are a part of it, the streams are not, so the retrials differ
+  // after the pending loads.
+  struct RestartSnapshot
+  {
+    Time                    time{0};
+    std::vector<GroupState> groups{};
+    std::vector<Load>       next_loads{};
+  };
+
+  // Weighted block times and their batch means are addressed by the index of the group in the
+  // chain and by the index of the traffic class.
+  RestartSettings                      restart_{};
+  std::vector<Group *>                 restart_groups_{};
+  std::vector<size_t>                  restart_retrials_{};
+  std::vector<double>                  restart_weights_{};
+  std::vector<std::vector<double>>     restart_block_time_{};
+  std::vector<std::vector<double>>     restart_block_total_{};
+  std::vector<std::vector<BatchMeans>> restart_block_{};
+  long double                          restart_measured_time_ = 0.0L;
+  Duration                             restart_batch_duration_{0};
+  Time                                 restart_batch_start_{0};
+  Time                                 restart_batch_end_{0};
+  uint64_t                             restart_splits_ = 0;
 
   Topology *                                     topology_{};
   std::unordered_map<TrafficClassId, BlockStats> blocked_by_tc{};
   std::unordered_map<Size, BlockStats>           blocked_by_size{};
 
   void process_event();
+  void discard_cancelled_events();
+  void process(Event &event);
+  void skip(Event &event);
+  void advance_time(Time next_event);
+  void on_time_advanced();
+  void pause_sources();
+  void end_epoch();
+  void end_warmup();
+  void sample_occupancy();
+  void detect_warmup();
+  void record_epoch(Duration epoch_duration);
+  bool is_precise_enough() const;
+
+  long double         offered_volume() const;
+  double              offered_volume_rate() const;
+  void                reset_controls();
+  std::vector<double> epoch_controls(Duration epoch_duration);
+
+  void   run_ticks(bool quiet);
+  void   run_events(bool quiet);
+  void   run_states(bool quiet, bool leaping);
+  bool   exact_transition(bool main_trial);
+  double draw_departure_delay();
+  void   end_departing_service();
+  bool   try_leap();
+
+  void            init_restart();
+  void            reset_restart();
+  size_t          restart_region() const;
+  void            restart_trial(size_t level, size_t region, bool quiet);
+  void            add_restart_time(double holding_time);
+  void            end_restart_batch(Time batch_end, bool full);
+  RestartSnapshot save_restart_state() const;
+  void            restore_restart_state(const RestartSnapshot &snapshot);
 
 public:
-  World(uint64_t seed, Duration duration);
+  World(
+      uint64_t               seed,
+      Duration               duration,
+      EventSetType           event_set_type = EventSetType::BinaryHeap,
+      ExponentialSamplerType exponential_sampler = ExponentialSamplerType::Ziggurat);
   World(const World &) = delete;
   World &operator=(const World &) = delete;
 
-  Uuid          get_uuid();
-  RandomEngine &get_random_engine();
-  Duration      get_tick_length() { return tick_length_; }
-  Time          get_time() const { return time_; }
-  Time          get_current_time() const { return current_time_; }
-  auto          get_progress() const { return Duration{time_} / duration_; }
+  Uuid                   get_uuid();
+  RandomEngine &         get_random_engine();
+  RandomEngine           make_random_engine(Uuid stream) const { return {seed_, stream}; }
+  ExponentialSamplerType get_exponential_sampler() const { return exponential_sampler_; }
+  Duration               get_tick_length() { return tick_length_; }
+  Time                   get_time() const { return time_; }
+  Time                   get_current_time() const { return current_time_; }
+  auto                   get_progress() const { return Duration{time_} / duration_; }
+  bool                   is_state_based() const { return state_based_; }
+  bool                   can_run_states() const;
 
   void set_topology(Topology &topology);
-  void schedule(std::unique_ptr<Event> event);
+  void set_epochs(const EpochSettings &epochs);
+  void set_warmup_detection(const WarmupDetection &warmup_detection);
+  void set_stop_condition(const StopCondition &stop_condition);
+  void set_leap_settings(const LeapSettings &leap_settings);
+  void set_restart(const RestartSettings &restart);
+  void set_control_variates(const ControlVariates &control_variates);
+  void schedule(EventPtr event);
+  void cancel(Event &event);
+
+  // Loads starting and ending their service in the state-based run (see Group::start_service()).
+  void add_departure_rate(double rate)
+  {
+    ++chain_.loads_in_service;
+    chain_.departure_rate += rate;
+  }
+  void remove_departure_rate(double rate)
+  {
+    --chain_.loads_in_service;
+    chain_.departure_rate = chain_.loads_in_service == 0 ? 0.0 : chain_.departure_rate - rate;
+  }
+
+  template <typename T, typename... Args>
+  PooledEventPtr<T> make_event(Args &&...args)
+  {
+    return event_pool_.make<T>(std::forward<Args>(args)...);
+  }
 
   void init();
   bool next_iteration();
-  void run(bool quiet);
+  void run(bool quiet, RunMode run_mode = RunMode::Auto);
 
   void            print_stats();
   nlohmann::json &append_stats(nlohmann::json &j);
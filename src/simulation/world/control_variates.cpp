@@ -0,0 +1,101 @@
+#include "simulation/world.h"
+
+#include "logger.h"
+#include "simulation/group.h"
+#include "simulation/source_stream/poisson.h"
+#include "simulation/source_stream/source_stream.h"
+#include "types/types_format.h"
+
+namespace Simulation {
+
+void
+World::set_control_variates(const ControlVariates &control_variates)
+{
+  ASSERT(topology_ != nullptr, "{} Control variates need the topology", *this);
+  control_variates_ = control_variates;
+  control_groups_.clear();
+  for (auto &[name, group] : topology_->groups)
+  {
+    if (auto it = control_variates_.mean_occupancy.find(name);
+        it != end(control_variates_.mean_occupancy))
+    {
+      control_groups_.emplace_back(group.get(), it->second);
+    }
+  }
+  previous_occupancy_area_.assign(control_groups_.size(), 0.0L);
+}
+
+// The retrials of RESTART produce loads too, so the offered volume is not a control then
+long double
+World::offered_volume() const
+{
+  long double volume = 0.0L;
+  for (const auto &[name, source] : topology_->sources)
+  {
+    std::ignore = name;
+    if (dynamic_cast<const PoissonSourceStream *>(source.get()) != nullptr)
+    {
+      volume += static_cast<long double>(source->loads_produced())
+                * static_cast<long double>(ts::get(source->tc_.size));
+    }
+  }
+  return volume;
+}
+
+double
+World::offered_volume_rate() const
+{
+  if (restart_.enabled())
+  {
+    return 0.0;
+  }
+  double rate = 0.0;
+  for (const auto &[name, source] : topology_->sources)
+  {
+    std::ignore = name;
+    if (dynamic_cast<const PoissonSourceStream *>(source.get()) != nullptr)
+    {
+      rate += static_cast<double>(ts::get(source->tc_.source_intensity))
+              * static_cast<double>(ts::get(source->tc_.size));
+    }
+  }
+  return rate;
+}
+
+void
+World::reset_controls()
+{
+  previous_offered_volume_ = offered_volume();
+  for (size_t i = 0; i < control_groups_.size(); ++i)
+  {
+    const auto *group = control_groups_[i].first;
+    previous_occupancy_area_[i] = group->stats_.occupancy_area_until(group->occupancy(), time_);
+  }
+}
+
+// The relative deviation of the offered volume from its mean and the deviations of the mean
+// occupancy of the groups from the analytical one, all of them have the expected value 0.
+std::vector<double>
+World::epoch_controls(Duration epoch_duration)
+{
+  const auto          duration = static_cast<double>(ts::get(epoch_duration));
+  std::vector<double> controls;
+  if (const auto rate = offered_volume_rate(); rate > 0.0)
+  {
+    const auto volume = offered_volume();
+    controls.push_back(
+        static_cast<double>(volume - previous_offered_volume_) / (rate * duration) - 1.0);
+    previous_offered_volume_ = volume;
+  }
+  for (size_t i = 0; i < control_groups_.size(); ++i)
+  {
+    const auto &[group, mean_occupancy] = control_groups_[i];
+    const auto area = group->stats_.occupancy_area_until(group->occupancy(), time_);
+    controls.push_back(
+        static_cast<double>(area - previous_occupancy_area_[i]) / duration - mean_occupancy);
+    previous_occupancy_area_[i] = area;
+  }
+  return controls;
+}
+
+} // namespace Simulation
@@ -0,0 +1,120 @@
+#include "simulation/world.h"
+
+#include "logger.h"
+#include "simulation/group.h"
+#include "types/types_format.h"
+
+namespace Simulation {
+
+// The epoch ends at the first iteration past its nominal end, so the epochs differ slightly in
+// length and the values are computed from the actual duration.
+void
+World::end_epoch()
+{
+  const auto epoch_duration = time_ - epoch_start_;
+  epoch_start_ = time_;
+  ++epoch_;
+
+  if (in_warmup_)
+  {
+    if (!warmup_detection_.enabled && epoch_ >= epochs_.warmup)
+    {
+      end_warmup();
+    }
+    return;
+  }
+  record_epoch(epoch_duration);
+
+  if (stop_condition_.enabled() && is_precise_enough())
+  {
+    debug_print("{} Stop condition is met\n", *this);
+    stopped_early_ = true;
+    finish_time_ = time_;
+    pause_sources();
+  }
+}
+
+void
+World::record_epoch(Duration epoch_duration)
+{
+  const auto controls =
+      control_variates_.enabled ? epoch_controls(epoch_duration) : std::vector<double>{};
+  for (auto &[name, group] : topology_->groups)
+  {
+    std::ignore = name;
+    const auto &stats = group->stats_;
+    for (size_t tc_index = 0; tc_index < stats.tc_ids.size(); ++tc_index)
+    {
+      const auto &served = stats.served_by_tc[tc_index];
+      if (served.lost.count == Count{0} && served.served.count == Count{0})
+      {
+        continue;
+      }
+      auto &estimates = estimates_[{group.get(), stats.tc_ids[tc_index]}];
+
+      const auto lost = ts::get(served.lost.count - estimates.previous.lost.count);
+      const auto offered = lost + ts::get(served.served.count - estimates.previous.served.count)
+                           + ts::get(served.forwarded.count - estimates.previous.forwarded.count);
+      if (offered > 0)
+      {
+        estimates.loss.add(static_cast<double>(lost) / static_cast<double>(offered));
+        if (control_variates_.enabled)
+        {
+          estimates.loss_controls.push_back(controls);
+        }
+      }
+
+      const auto block_time = stats.blocked_by_tc[tc_index].block_time_until(time_);
+      estimates.block.add(
+          static_cast<double>((block_time - estimates.previous_block_time) / epoch_duration));
+      if (control_variates_.enabled)
+      {
+        estimates.block_controls.push_back(controls);
+      }
+
+      estimates.previous = served;
+      estimates.previous_block_time = block_time;
+    }
+  }
+}
+
+// Every estimate has to be precise enough. Estimates which stayed zero since the start are not
+// tracked, e.g. P_loss in the groups which forward all the requests they cannot serve.
+bool
+World::is_precise_enough() const
+{
+  bool any_tracked = false;
+  for (const auto &[key, estimates] : estimates_)
+  {
+    std::ignore = key;
+    if (estimates.block.size() < stop_condition_.min_epochs)
+    {
+      return false;
+    }
+    const auto lost = static_cast<uint64_t>(ts::get(estimates.previous.lost.count));
+    const auto track_loss = lost > 0;
+    const auto track_block = estimates.block.mean() > 0.0;
+    if (!track_loss && !track_block)
+    {
+      continue;
+    }
+    any_tracked = true;
+
+    if (stop_condition_.min_lost > 0 && lost >= stop_condition_.min_lost)
+    {
+      continue;
+    }
+    if (stop_condition_.relative_precision > 0.0
+        && (!track_loss
+            || estimates.loss.relative_half_width() <= stop_condition_.relative_precision)
+        && (!track_block
+            || estimates.block.relative_half_width() <= stop_condition_.relative_precision))
+    {
+      continue;
+    }
+    return false;
+  }
+  return any_tracked;
+}
+
+} // namespace Simulation
@@ -0,0 +1,158 @@
+#include "simulation/world.h"
+
+#include "simulation/group.h"
+#include "simulation/source_stream/poisson.h"
+#include "types/types_format.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <utility>
+
+namespace Simulation {
+
+void
+World::set_leap_settings(const LeapSettings &leap_settings)
+{
+  leap_settings_ = leap_settings;
+}
+
+// The leap is as long as the arrivals expected during it take at most the epsilon fraction of the
+// free capacity which every group has above its largest request, and the departures expected from
+// every group at most the epsilon fraction of its occupancy. A request may be forwarded to any
+// group, so the leap is cut short before the requests together would not fit into that free
+// capacity of every group. Then none of them can be blocked or lost and the blocking states do not
+// change during the leap, only at the exact transitions near the capacity.
+bool
+World::try_leap()
+{
+  const auto arrivals = time_ <= finish_time_;
+  auto       tau = std::numeric_limits<double>::infinity();
+  auto       headroom = std::numeric_limits<double>::infinity();
+  double     total_rate = chain_.departure_rate;
+  for (const auto *group : chain_.groups)
+  {
+    double max_size = 0.0;
+    double occupancy = 0.0;
+    double departure_volume_rate = 0.0;
+    for (size_t tc_index = 0; tc_index < group->in_service_.size(); ++tc_index)
+    {
+      const auto size = static_cast<double>(ts::get(group->tcs_attributes_[tc_index].tc->size));
+      max_size = std::max(max_size, size);
+      occupancy += size * static_cast<double>(group->in_service_[tc_index].size());
+      departure_volume_rate += size * group->departure_rate(tc_index);
+    }
+    double free_capacity = 0.0;
+    for (const auto &bucket_free_capacity : group->free_capacity())
+    {
+      free_capacity = std::max(free_capacity, static_cast<double>(ts::get(bucket_free_capacity)));
+    }
+    headroom = std::min(headroom, free_capacity - max_size);
+    if (departure_volume_rate > 0.0)
+    {
+      tau = std::min(tau, leap_settings_.epsilon * occupancy / departure_volume_rate);
+    }
+  }
+  if (headroom < 0.0)
+  {
+    return false;
+  }
+
+  double arrival_volume_rate = 0.0;
+  if (arrivals)
+  {
+    for (size_t source_index = 0; source_index < chain_.sources.size(); ++source_index)
+    {
+      arrival_volume_rate +=
+          chain_.arrival_rates[source_index]
+          * static_cast<double>(ts::get(chain_.sources[source_index]->tc_.size));
+      total_rate += chain_.arrival_rates[source_index];
+    }
+  }
+  if (arrival_volume_rate > 0.0)
+  {
+    tau = std::min(tau, leap_settings_.epsilon * headroom / arrival_volume_rate);
+    tau = std::min(tau, static_cast<double>(ts::get(finish_time_ - time_)));
+  }
+  if (!(tau * total_rate >= leap_settings_.min_transitions))
+  {
+    return false;
+  }
+
+  // The arrivals of the leap are the pending loads of the sources sent before its end, taken in the
+  // order of time. If they do not fit into the headroom, the leap ends at the first one which does
+  // not fit and that load stays pending.
+  auto   leap_end = time_ + Duration{tau};
+  double arrivals_volume = 0.0;
+  chain_.leap_arrivals.clear();
+  while (arrivals)
+  {
+    auto next_source = chain_.sources.size();
+    for (size_t source_index = 0; source_index < chain_.sources.size(); ++source_index)
+    {
+      const auto send_time = chain_.next_loads[source_index].send_time;
+      if (send_time <= leap_end
+          && (next_source == chain_.sources.size()
+              || send_time < chain_.next_loads[next_source].send_time))
+      {
+        next_source = source_index;
+      }
+    }
+    if (next_source == chain_.sources.size())
+    {
+      break;
+    }
+    auto &     next_load = chain_.next_loads[next_source];
+    const auto size = static_cast<double>(ts::get(next_load.size));
+    if (arrivals_volume + size > headroom)
+    {
+      leap_end = next_load.send_time;
+      break;
+    }
+    arrivals_volume += size;
+    chain_.leap_arrivals.push_back(std::exchange(
+        next_load, chain_.sources[next_source]->produce_next_load(next_load.send_time)));
+  }
+  if (!(leap_end > time_))
+  {
+    return false;
+  }
+  tau = static_cast<double>(ts::get(leap_end - time_));
+
+  time_ = leap_end;
+  current_time_ = time_;
+  on_time_advanced();
+
+  // The departures are drawn for the requests in service at the beginning of the leap,
+  // so they are taken off before the arrivals of the leap are served
+  for (auto *group : chain_.groups)
+  {
+    for (size_t tc_index = 0; tc_index < group->in_service_.size(); ++tc_index)
+    {
+      const auto in_service = group->in_service_[tc_index].size();
+      if (in_service == 0)
+      {
+        continue;
+      }
+      const auto p = -std::expm1(-tau / group->tcs_attributes_[tc_index].mean_service_time);
+      auto       departures =
+          std::binomial_distribution<uint64_t>{in_service, p}(group->random_engine_);
+      processed_events_ += departures;
+      for (; departures > 0; --departures)
+      {
+        group->end_service(tc_index, time_);
+      }
+    }
+  }
+  processed_events_ += chain_.leap_arrivals.size();
+  for (auto &load : chain_.leap_arrivals)
+  {
+    load.send_time = time_;
+    topology_->group_at(load.target_group).try_serve(std::move(load));
+  }
+  ++leaps_;
+  return true;
+}
+
+} // namespace Simulation
@@ -0,0 +1,237 @@
+#include "simulation/world.h"
+
+#include "logger.h"
+#include "simulation/group.h"
+#include "simulation/stats.h"
+#include "types/types_format.h"
+
+#include <algorithm>
+
+namespace Simulation {
+
+void
+World::set_restart(const RestartSettings &restart)
+{
+  restart_ = restart;
+}
+
+void
+World::init_restart()
+{
+  const auto thresholds = restart_.thresholds.size();
+  ASSERT(
+      std::is_sorted(begin(restart_.thresholds), end(restart_.thresholds)),
+      "{} RESTART thresholds have to be increasing",
+      *this);
+  ASSERT(
+      restart_.retrials.size() == 1 || restart_.retrials.size() == thresholds,
+      "{} RESTART needs a single number of retrials or one for every threshold",
+      *this);
+  ASSERT(restart_.batches > 0, "{} RESTART needs at least one batch", *this);
+
+  restart_retrials_ = restart_.retrials.size() == 1
+                          ? std::vector<size_t>(thresholds, restart_.retrials.front())
+                          : restart_.retrials;
+  restart_weights_.assign(1, 1.0);
+  for (const auto retrials : restart_retrials_)
+  {
+    ASSERT(retrials > 0, "{} RESTART needs at least one retrial", *this);
+    restart_weights_.push_back(restart_weights_.back() / static_cast<double>(retrials));
+  }
+
+  restart_groups_.clear();
+  for (auto *group : chain_.groups)
+  {
+    if (restart_.groups.empty()
+        || std::find(begin(restart_.groups), end(restart_.groups), group->name())
+               != end(restart_.groups))
+    {
+      restart_groups_.push_back(group);
+    }
+  }
+  ASSERT(!restart_groups_.empty(), "{} RESTART groups not found in the topology", *this);
+
+  restart_block_time_.clear();
+  restart_block_total_.clear();
+  restart_block_.clear();
+  for (const auto *group : chain_.groups)
+  {
+    restart_block_time_.emplace_back(group->tcs_attributes_.size(), 0.0);
+    restart_block_total_.emplace_back(group->tcs_attributes_.size(), 0.0);
+    restart_block_.emplace_back(group->tcs_attributes_.size());
+  }
+  restart_batch_duration_ =
+      Duration{ts::get(duration_) / static_cast<long double>(restart_.batches)};
+  reset_restart();
+}
+
+void
+World::reset_restart()
+{
+  for (size_t group_index = 0; group_index < restart_block_.size(); ++group_index)
+  {
+    std::fill(
+        begin(restart_block_time_[group_index]), end(restart_block_time_[group_index]), 0.0);
+    std::fill(
+        begin(restart_block_total_[group_index]), end(restart_block_total_[group_index]), 0.0);
+    std::fill(
+        begin(restart_block_[group_index]), end(restart_block_[group_index]), BatchMeans{});
+  }
+  restart_measured_time_ = 0.0L;
+  restart_batch_start_ = time_;
+  restart_batch_end_ = time_;
+  restart_batch_end_ += restart_batch_duration_;
+}
+
+size_t
+World::restart_region() const
+{
+  double importance = 0.0;
+  for (const auto *group : restart_groups_)
+  {
+    for (const auto &size : group->size_)
+    {
+      importance += static_cast<double>(ts::get(size));
+    }
+  }
+  return static_cast<size_t>(
+      std::upper_bound(begin(restart_.thresholds), end(restart_.thresholds), importance)
+      - begin(restart_.thresholds));
+}
+
+// A trial of level k > 0 starts at the k-th threshold and is killed when the importance falls
+// below it, the main trial (level 0) runs until the end of the simulation. Every upward crossing of
+// a threshold by any trial splits it, a single transition may cross several thresholds. Only the
+// main trial advances the epochs, can stop the simulation early and prints the progress, the
+// retrials are quiet.
+void
+World::restart_trial(size_t level, size_t region, bool quiet)
+{
+  long double stats_freq = 0.25L;
+  int         i = 1;
+  for (;;)
+  {
+    const auto current = restart_region();
+    if (current < level)
+    {
+      return;
+    }
+    for (; region < current; ++region)
+    {
+      const auto snapshot = save_restart_state();
+      for (size_t retrial = 1; retrial < restart_retrials_[region]; ++retrial)
+      {
+        ++restart_splits_;
+        restart_trial(region + 1, region + 1, true);
+        restore_restart_state(snapshot);
+      }
+    }
+    region = current;
+
+    if (level > 0 && time_ > finish_time_)
+    {
+      return;
+    }
+    if (!exact_transition(level == 0))
+    {
+      return;
+    }
+    if (level == 0)
+    {
+      while (time_ >= restart_batch_end_ && restart_batch_end_ <= finish_time_)
+      {
+        end_restart_batch(restart_batch_end_, true);
+        restart_batch_end_ += restart_batch_duration_;
+      }
+      if (!quiet && get_progress() > stats_freq * i)
+      {
+        print_stats();
+        ++i;
+      }
+    }
+  }
+}
+
+// The time of the trials is measured only until the end of the simulation, the blocking states of
+// the classes are those of the block stats of the groups.
+void
+World::add_restart_time(double holding_time)
+{
+  const auto left = static_cast<double>(ts::get(finish_time_ - time_));
+  const auto measured = std::min(holding_time, left);
+  if (measured <= 0.0)
+  {
+    return;
+  }
+  const auto weighted = measured * restart_weights_[restart_region()];
+  for (size_t group_index = 0; group_index < chain_.groups.size(); ++group_index)
+  {
+    const auto &blocked_by_tc = chain_.groups[group_index]->stats_.blocked_by_tc;
+    for (size_t tc_index = 0; tc_index < blocked_by_tc.size(); ++tc_index)
+    {
+      if (blocked_by_tc[tc_index].is_blocked)
+      {
+        restart_block_time_[group_index][tc_index] += weighted;
+      }
+    }
+  }
+}
+
+// The weighted block times gathered since the start of the batch, including those of the retrials
+// split off in it, divided by the duration of the batch of the main trial. A partial batch at the
+// end of the simulation counts only to the totals.
+void
+World::end_restart_batch(Time batch_end, bool full)
+{
+  const auto duration = ts::get(batch_end - restart_batch_start_);
+  if (duration <= 0.0L)
+  {
+    return;
+  }
+  for (size_t group_index = 0; group_index < restart_block_.size(); ++group_index)
+  {
+    for (size_t tc_index = 0; tc_index < restart_block_[group_index].size(); ++tc_index)
+    {
+      auto &block_time = restart_block_time_[group_index][tc_index];
+      if (full)
+      {
+        restart_block_[group_index][tc_index].add(block_time / static_cast<double>(duration));
+      }
+      restart_block_total_[group_index][tc_index] += block_time;
+      block_time = 0.0;
+    }
+  }
+  restart_measured_time_ += duration;
+  restart_batch_start_ = batch_end;
+}
+
+World::RestartSnapshot
+World::save_restart_state() const
+{
+  RestartSnapshot snapshot{time_, {}, chain_.next_loads};
+  snapshot.groups.reserve(chain_.groups.size());
+  for (const auto *group : chain_.groups)
+  {
+    snapshot.groups.push_back(group->save_state());
+  }
+  return snapshot;
+}
+
+void
+World::restore_restart_state(const RestartSnapshot &snapshot)
+{
+  time_ = snapshot.time;
+  current_time_ = snapshot.time;
+  chain_.next_loads = snapshot.next_loads;
+  chain_.loads_in_service = 0;
+  chain_.departure_rate = 0.0;
+  for (size_t group_index = 0; group_index < chain_.groups.size(); ++group_index)
+  {
+    auto *group = chain_.groups[group_index];
+    group->restore_state(snapshot.groups[group_index]);
+    chain_.loads_in_service += group->loads_in_service_;
+    chain_.departure_rate += group->departure_rate();
+  }
+}
+
+} // namespace Simulation
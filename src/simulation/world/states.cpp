@@ -0,0 +1,219 @@
+#include "simulation/world.h"
+
+#include "simulation/event_format.h"
+#include "simulation/exponential.h"
+#include "simulation/group.h"
+#include "simulation/source_stream/poisson.h"
+#include "simulation/source_stream/source_stream.h"
+#include "types/types_format.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace Simulation {
+
+// The CTMC of the system has to be defined by the numbers of the loads in service: the arrivals
+// have to be Poisson and the holding times exponential with the rate of the traffic class, so the
+// compression is not supported. The only pending events can be the first requests of the sources.
+bool
+World::can_run_states() const
+{
+  for (const auto &[name, source] : topology_->sources)
+  {
+    std::ignore = name;
+    if (dynamic_cast<const PoissonSourceStream *>(source.get()) == nullptr)
+    {
+      return false;
+    }
+  }
+  for (const auto &[name, group] : topology_->groups)
+  {
+    std::ignore = name;
+    if (!group->tcs_compression_.empty())
+    {
+      return false;
+    }
+  }
+  return events_->size() == topology_->sources.size();
+}
+
+// Exact simulation of the continuous-time Markov chain (D. T. Gillespie, 1977). Only the numbers of
+// the loads in service are tracked, the service end events are not created and the loads of a class
+// in a group are indistinguishable. The arrivals are those of the event-driven run: every source
+// keeps its next load pending, drawn from its own stream and thinned in the coupled sweep. The
+// departures of all the groups are drawn from a single stream at their total rate. As in the
+// event-driven run the arrivals stop at the end of the simulation and the loads in service are
+// drained.
+void
+World::run_states(bool quiet, bool leaping)
+{
+  state_based_ = true;
+  for (auto &[name, source] : topology_->sources)
+  {
+    std::ignore = name;
+    chain_.sources.push_back(static_cast<PoissonSourceStream *>(source.get()));
+    chain_.arrival_rates.push_back(static_cast<double>(ts::get(source->tc_.source_intensity)));
+  }
+  chain_.next_loads.resize(chain_.sources.size());
+  while (!events_->empty())
+  {
+    auto event = events_->pop();
+    ASSERT(
+        event->type == EventType::LoadServiceRequest,
+        "{} Pending event {} is not a first request of a source",
+        *this,
+        *event);
+    // The sources of the chain are in the order of the topology, as their indices
+    auto &load = static_cast<LoadServiceRequestEvent &>(*event).load;
+    chain_.next_loads[load.produced_by] = std::move(load);
+  }
+
+  for (auto &[name, group] : topology_->groups)
+  {
+    std::ignore = name;
+    chain_.groups.push_back(group.get());
+  }
+
+  if (restart_.enabled())
+  {
+    init_restart();
+    restart_trial(0, 0, quiet);
+    end_restart_batch(std::min(time_, finish_time_), false);
+    return;
+  }
+
+  long double stats_freq = 0.25L;
+  int         i = 1;
+  for (;;)
+  {
+    if (!leaping || !try_leap())
+    {
+      if (!exact_transition(true))
+      {
+        break;
+      }
+    }
+
+    if (!quiet && processed_events_ % progress_check_interval_ == 0
+        && get_progress() > stats_freq * i)
+    {
+      print_stats();
+      ++i;
+    }
+  }
+}
+
+// The next transition is the earliest of the pending arrivals and of the departure drawn from the
+// total departure rate of the groups, which they keep up to date as the loads start and end their
+// service. A departure which does not come first is discarded, the holding times are exponential
+// so it is drawn anew at every transition.
+bool
+World::exact_transition(bool main_trial)
+{
+  const auto arrivals = time_ <= finish_time_;
+  auto       holding_time = std::numeric_limits<double>::infinity();
+  auto       arriving_source = chain_.sources.size();
+  for (size_t source_index = 0; arrivals && source_index < chain_.sources.size(); ++source_index)
+  {
+    const auto delay =
+        static_cast<double>(ts::get(chain_.next_loads[source_index].send_time - time_));
+    if (delay < holding_time)
+    {
+      holding_time = delay;
+      arriving_source = source_index;
+    }
+  }
+  auto departure = false;
+  if (chain_.loads_in_service > 0)
+  {
+    if (const auto delay = draw_departure_delay(); delay < holding_time)
+    {
+      holding_time = delay;
+      departure = true;
+    }
+  }
+  if (!departure && arriving_source == chain_.sources.size())
+  {
+    return false;
+  }
+
+  if (restart_.enabled())
+  {
+    add_restart_time(holding_time);
+  }
+  if (!departure)
+  {
+    time_ = chain_.next_loads[arriving_source].send_time;
+  }
+  else
+  {
+    time_ += Duration{holding_time};
+  }
+  current_time_ = time_;
+  if (main_trial)
+  {
+    on_time_advanced();
+  }
+
+  if (departure)
+  {
+    end_departing_service();
+  }
+  else
+  {
+    auto &next_load = chain_.next_loads[arriving_source];
+    auto  load =
+        std::exchange(next_load, chain_.sources[arriving_source]->produce_next_load(time_));
+    // The arrivals past the end of the simulation are not offered, as in the event-driven run
+    // where the sources are paused.
+    if (time_ <= finish_time_)
+    {
+      topology_->group_at(load.target_group).try_serve(std::move(load));
+    }
+  }
+  ++processed_events_;
+  return true;
+}
+
+// Drawn with the sampler of the holding times of the event-driven run (see
+// Group::set_end_time()).
+double
+World::draw_departure_delay()
+{
+  const auto rate = chain_.departure_rate;
+  if (exponential_sampler_ == ExponentialSamplerType::Reference)
+  {
+    chain_.departure_exponential.param(
+        decltype(chain_.departure_exponential)::param_type(rate));
+    return static_cast<double>(chain_.departure_exponential(departure_engine_));
+  }
+  return ziggurat_exponential()(departure_engine_) / rate;
+}
+
+// The departing group and then its class are picked in proportion to their departure rates with a
+// single uniform.
+void
+World::end_departing_service()
+{
+  auto   u = ZigguratExponential::uniform(departure_engine_) * chain_.departure_rate;
+  Group *departing_group = nullptr;
+  for (auto *group : chain_.groups)
+  {
+    const auto rate = group->departure_rate();
+    if (rate <= 0.0)
+    {
+      continue;
+    }
+    // The last non-empty group takes the remainder of the rounding errors
+    departing_group = group;
+    if (u < rate)
+    {
+      break;
+    }
+    u -= rate;
+  }
+  departing_group->end_service(departing_group->departing_tc_index(u), time_);
+}
+
+} // namespace Simulation
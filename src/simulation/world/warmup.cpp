@@ -0,0 +1,76 @@
+#include "simulation/world.h"
+
+#include "logger.h"
+#include "simulation/group.h"
+#include "simulation/stats.h"
+#include "types/types_format.h"
+
+namespace Simulation {
+
+void
+World::end_warmup()
+{
+  debug_print("{} End of warm-up\n", *this);
+  for (auto &[name, group] : topology_->groups)
+  {
+    std::ignore = name;
+    group->stats_.reset(time_);
+  }
+  stats_start_ = time_;
+  epoch_start_ = time_;
+  in_warmup_ = false;
+  if (restart_.enabled())
+  {
+    reset_restart();
+  }
+  if (control_variates_.enabled)
+  {
+    reset_controls();
+  }
+}
+
+// The occupancy is constant between the iterations, so it is also the value of the samples
+// skipped since the previous iteration.
+void
+World::sample_occupancy()
+{
+  double occupancy = 0.0;
+  for (const auto &[name, group] : topology_->groups)
+  {
+    std::ignore = name;
+    for (const auto &size : group->size_)
+    {
+      occupancy += static_cast<double>(ts::get(size));
+    }
+  }
+  while (time_ >= next_sample_)
+  {
+    occupancy_samples_.push_back(occupancy);
+    next_sample_ += warmup_detection_.sample_interval;
+  }
+
+  if (occupancy_samples_.size() >= next_detection_)
+  {
+    detect_warmup();
+  }
+}
+
+// The stats gathered since the truncation point cannot be separated from the earlier ones, so
+// they are reset at the moment of the detection.
+void
+World::detect_warmup()
+{
+  const auto truncation = mser_truncation(occupancy_samples_);
+  if (!truncation)
+  {
+    next_detection_ *= 2;
+    return;
+  }
+  truncation_point_ = Time{
+      static_cast<time_type<>>(*truncation) * ts::get(warmup_detection_.sample_interval)};
+  debug_print("{} Warm-up detected, truncation point {}\n", *this, *truncation_point_);
+  end_warmup();
+  occupancy_samples_ = {};
+}
+
+} // namespace Simulation
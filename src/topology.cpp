@@ -5,7 +5,55 @@
 #include "simulation/source_stream/source_stream.h"
 #include "types/types_format.h"
 
+#include <algorithm>
+
 namespace Simulation {
+namespace {
+// Number of the groups on the longest simple path through the next groups
+// which continues the given one, the search stops at limit groups.
+size_t
+longest_simple_path(std::vector<const Group *> &path, size_t limit)
+{
+  auto longest = path.size();
+  for (const auto *next_group : path.back()->next_groups_)
+  {
+    if (longest >= limit)
+    {
+      break;
+    }
+    if (std::find(begin(path), end(path), next_group) == end(path))
+    {
+      path.emplace_back(next_group);
+      longest = std::max(longest, longest_simple_path(path, limit));
+      path.pop_back();
+    }
+  }
+  return longest;
+}
+
+// Whether an overflow chain through the next groups which continues the given
+// one returns to a group on it.
+bool
+returns_to_path(std::vector<const Group *> &path)
+{
+  for (const auto *next_group : path.back()->next_groups_)
+  {
+    if (std::find(begin(path), end(path), next_group) != end(path))
+    {
+      return true;
+    }
+    path.emplace_back(next_group);
+    const auto returns = returns_to_path(path);
+    path.pop_back();
+    if (returns)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+} // namespace
+
 Group &
 Topology::add_group(std::unique_ptr<Group> group)
 {
@@ -90,6 +138,95 @@ Topology::set_world(World &world)
     source->set_world(world);
   }
 }
+// Traffic classes, groups and sources are addressed in the simulation by their
+// positions in traffic_classes, groups and sources, so the groups and loads need
+// no lookups by the id.
+void
+Topology::compile()
+{
+  uint32_t group_index = 0;
+  for (auto &[name, group] : groups)
+  {
+    std::ignore = name;
+    group->index_ = group_index++;
+    group->compile();
+  }
+  // The reverse links are set after the groups are final, the hybrid
+  // simulation removes some of them from the topology.
+  for (auto &[name, group] : groups)
+  {
+    std::ignore = name;
+    for (auto *next_group : group->next_groups())
+    {
+      next_group->previous_groups_.emplace_back(group.get());
+    }
+  }
+  // The path of a load is kept inline (see Load), the topologies in which a
+  // load could visit more groups are rejected.
+  Length max_path_length = 0;
+  for (const auto &[id, tc] : traffic_classes)
+  {
+    std::ignore = id;
+    max_path_length = std::max(max_path_length, tc.max_path_length);
+  }
+  if (max_path_length > MaxServedByLength)
+  {
+    std::vector<const Group *> path;
+    for (const auto &[name, group] : groups)
+    {
+      path.assign({group.get()});
+      ASSERT(
+          longest_simple_path(path, MaxServedByLength + 1) <= MaxServedByLength,
+          "[{}] [Topology] Overflow chain from the group {} is longer than {} groups, limit "
+          "max_path_length of the traffic classes to {}.",
+          location(),
+          name,
+          MaxServedByLength,
+          MaxServedByLength);
+    }
+  }
+  // Without the recorded paths the loads cannot avoid the groups they visited.
+  if constexpr (!Config::record_load_path)
+  {
+    std::vector<const Group *> path;
+    for (const auto &[name, group] : groups)
+    {
+      path.assign({group.get()});
+      ASSERT(
+          !returns_to_path(path),
+          "[{}] [Topology] Overflow chain from the group {} returns to a visited group, enable "
+          "Config::record_load_path.",
+          location(),
+          name);
+    }
+  }
+  uint32_t source_index = 0;
+  for (auto &[name, source] : sources)
+  {
+    std::ignore = name;
+    source->set_index(source_index++);
+    const auto tc_it = traffic_classes.find(source->tc_.id);
+    ASSERT(
+        tc_it != end(traffic_classes),
+        "[{}] [Topology] Traffic class with id {} does not exist.",
+        location(),
+        source->tc_.id);
+    source->set_traffic_class_index(traffic_classes.index_of(tc_it));
+  }
+}
+
+Group &
+Topology::group_at(uint32_t index) const
+{
+  return *groups.nth(index)->second;
+}
+
+SourceStream &
+Topology::source_at(uint32_t index) const
+{
+  return *sources.nth(index)->second;
+}
+
 std::optional<SourceStream *>
 Topology::find_source_by_tc_id(TrafficClassId id) const
 {
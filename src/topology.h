@@ -4,6 +4,7 @@
 #include "types/types.h"
 
 #include <boost/container/flat_map.hpp>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -43,6 +44,12 @@ struct Topology
   void attach_source_to_group(const SourceName &source, const GroupName &group);
 
   void set_world(World &world);
+  void compile();
+
+  // Groups and sources are addressed in the loads by their positions in groups
+  // and sources (see compile()).
+  Group &       group_at(uint32_t index) const;
+  SourceStream &source_at(uint32_t index) const;
 
   std::optional<SourceStream *> find_source_by_tc_id(TrafficClassId id) const;
   std::optional<SourceId>       get_source_id(const SourceName &name) const;
@@ -0,0 +1,103 @@
+#include <catch2/catch_test_macros.hpp>
+#include "simulation/event_pool.h"
+#include "simulation/event_set/event_set.h"
+
+#include <random>
+
+using namespace Simulation;
+
+namespace {
+std::vector<Uuid>
+schedule_and_drain(EventSet &events, EventPool &pool, const std::vector<long double> &times)
+{
+  Uuid id = 0;
+  for (auto time : times)
+  {
+    events.push(pool.make<Event>(EventType::None, ++id, Time{time}));
+  }
+  std::vector<Uuid> order;
+  while (!events.empty())
+  {
+    order.push_back(events.pop()->id);
+  }
+  return order;
+}
+} // namespace
+
+TEST_CASE("events are popped in order of time and scheduling", "[event_set]")
+{
+  const std::vector<long double> times{3.0L, 1.0L, 2.0L, 1.0L, 0.5L, 3.0L};
+  const std::vector<Uuid>        expected{5, 2, 4, 3, 1, 6};
+
+  EventPool     pool;
+  BinaryHeap    heap;
+  CalendarQueue calendar;
+  REQUIRE(expected == schedule_and_drain(heap, pool, times));
+  REQUIRE(expected == schedule_and_drain(calendar, pool, times));
+}
+
+TEST_CASE("calendar queue follows binary heap", "[event_set]")
+{
+  EventPool     pool;
+  BinaryHeap    heap;
+  CalendarQueue calendar;
+
+  std::mt19937_64                             engine{0};
+  std::exponential_distribution<long double> hold_time{1.0L};
+
+  // Interleaves scheduling and processing like the simulation does, the set
+  // grows and shrinks several times to exercise resizing of the calendar.
+  Uuid        id = 0;
+  long double now = 0.0L;
+  for (int phase = 0; phase < 6; ++phase)
+  {
+    const auto target_size = phase % 2 == 0 ? 2000u : 10u;
+    while (heap.size() != target_size)
+    {
+      if (heap.size() < target_size)
+      {
+        const Time time{now + hold_time(engine)};
+        ++id;
+        heap.push(pool.make<Event>(EventType::None, id, time));
+        calendar.push(pool.make<Event>(EventType::None, id, time));
+      }
+      else
+      {
+        auto expected = heap.pop();
+        auto event = calendar.pop();
+        REQUIRE(expected->id == event->id);
+        now = ts::get(event->time);
+      }
+    }
+    REQUIRE(heap.size() == calendar.size());
+  }
+}
+
+TEST_CASE("cancelled events are removed from the event set", "[event_set]")
+{
+  EventPool     pool;
+  BinaryHeap    heap;
+  CalendarQueue calendar;
+
+  for (EventSet *events : std::initializer_list<EventSet *>{&heap, &calendar})
+  {
+    Uuid id = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+      auto event = pool.make<Event>(EventType::None, ++id, Time{static_cast<long double>(i % 7)});
+      event->cancelled = id % 3 == 0;
+      events->push(std::move(event));
+    }
+    REQUIRE(events->remove_cancelled() == 33);
+    REQUIRE(events->size() == 67);
+
+    Time previous{0};
+    while (!events->empty())
+    {
+      auto event = events->pop();
+      REQUIRE_FALSE(event->cancelled);
+      REQUIRE(previous <= event->time);
+      previous = event->time;
+    }
+  }
+}
@@ -52,6 +52,33 @@ TEST_CASE("n_over_k_int64 negative n - highp", "[math]")
   REQUIRE(1 == Math::n_over_k(highp::int_t(-5), highp::int_t(0)));
 }
 
+TEST_CASE("n_over_k exact", "[math]")
+{
+  REQUIRE(118264581564861424 == Math::n_over_k(int64_t(60), int64_t(30)));
+  REQUIRE(
+      highp::int_t("100891344545564193334812497256")
+      == Math::n_over_k(highp::int_t(100), highp::int_t(50)));
+  REQUIRE(0 == Math::n_over_k(int64_t(3), int64_t(5)));
+  REQUIRE(
+      Math::binomial_coefficient(20'000, 3)
+      == mp::cpp_int(20'000) * 19'999 * 19'998 / 6);
+  REQUIRE(0 == Math::n_over_k(highp::int_t(3), highp::int_t(5)));
+}
+
+TEST_CASE("binomial_coefficient, cached and direct", "[math]")
+{
+  // The cache holds n < 4096 and k <= 32, the other coefficients are computed directly.
+  for (uint64_t n : {4095, 4096})
+  {
+    for (uint64_t k : {31, 32, 33})
+    {
+      REQUIRE(
+          Math::binomial_coefficient(n, k)
+          == Math::binomial_coefficient(n - 1, k - 1) + Math::binomial_coefficient(n - 1, k));
+    }
+  }
+}
+
 TEST_CASE("n_over_k_int64 positive n - Capacity", "[math]")
 {
   using Model::Capacity;
@@ -1,7 +1,9 @@
 #include "model/overflow_far.h"
 #include "model/overflow_far.cpp"
 
-#include <catch.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
 
 using namespace Model;
 
@@ -97,3 +99,147 @@ TEST_CASE(
       == combinatorial_arrangement_number_unequal_resources(
           Capacity{6}, resource));
 }
+
+static double
+erlang_b(double A, int V)
+{
+  double blocking = 1.0;
+  for (int n = 1; n <= V; ++n)
+  {
+    blocking = A * blocking / (n + A * blocking);
+  }
+  return blocking;
+}
+
+TEST_CASE("kaufman_roberts_distributions, single class, V=3", "[overflow_far]")
+{
+  IncomingRequestStreams in_request_streams{IncomingRequestStream{TrafficClass{
+      TrafficClassId{1},
+      Simulation::Intensity{2.0L},
+      Simulation::Intensity{1.0L},
+      Simulation::Size{1},
+      {}}}};
+  const auto distributions = kaufman_roberts_distributions(
+      in_request_streams,
+      Resource<CapacityF>{CapacityF{3}},
+      Size{1},
+      KaufmanRobertsVariant::FixedReqSize);
+
+  REQUIRE(distributions.size() == 2);
+  REQUIRE(distributions[0].size() == 4);
+  REQUIRE(distributions[1].size() == 5);
+  REQUIRE(static_cast<double>(get(distributions[0][3])) == Catch::Approx(4.0 / 19.0));
+  REQUIRE(static_cast<double>(get(distributions[1][4])) == Catch::Approx(erlang_b(2.0, 4)));
+}
+
+TEST_CASE("kaufman_roberts_distributions, rescaling, V=5000", "[overflow_far]")
+{
+  IncomingRequestStreams in_request_streams{IncomingRequestStream{TrafficClass{
+      TrafficClassId{1},
+      Simulation::Intensity{4500.0L},
+      Simulation::Intensity{1.0L},
+      Simulation::Size{1},
+      {}}}};
+  const auto distributions = kaufman_roberts_distributions(
+      in_request_streams,
+      Resource<CapacityF>{CapacityF{5000}},
+      Size{1},
+      KaufmanRobertsVariant::FixedReqSize);
+
+  REQUIRE(
+      static_cast<double>(get(distributions[0].back()))
+      == Catch::Approx(erlang_b(4500.0, 5000)).epsilon(1e-9));
+  REQUIRE(
+      static_cast<double>(get(distributions[1].back()))
+      == Catch::Approx(erlang_b(4500.0, 5001)).epsilon(1e-9));
+}
+
+TEST_CASE("kaufman_roberts_distribution, high precision fallback, V=2000", "[overflow_far]")
+{
+  // The states 1/n! of A=1 underflow in long double from about n=1750 on, the recursion is
+  // repeated in high precision.
+  IncomingRequestStreams in_request_streams{IncomingRequestStream{TrafficClass{
+      TrafficClassId{1},
+      Simulation::Intensity{1.0L},
+      Simulation::Intensity{1.0L},
+      Simulation::Size{1},
+      {}}}};
+  REQUIRE(!kaufman_roberts_states<long double>(
+      in_request_streams,
+      Resource<CapacityF>{CapacityF{2000}},
+      Capacity{2000},
+      KaufmanRobertsVariant::FixedReqSize));
+
+  const auto distribution = kaufman_roberts_distribution(
+      in_request_streams,
+      Resource<CapacityF>{CapacityF{1999}},
+      Size{1},
+      KaufmanRobertsVariant::FixedReqSize);
+
+  REQUIRE(distribution.size() == 2001);
+  REQUIRE(static_cast<double>(get(distribution[0])) == Catch::Approx(std::exp(-1.0)));
+  REQUIRE(get(distribution[2000]) > 0);
+  REQUIRE(
+      static_cast<double>(get(distribution[2000]) / get(distribution[1999]))
+      == Catch::Approx(1.0 / 2000.0));
+}
+
+TEST_CASE("transition_probabilities, v_s=3, f_s=4", "[overflow_far]")
+{
+  const ResourceComponent<CapacityF> component{Count{3}, CapacityF{4}};
+  const Resource<CapacityF>          resource{component};
+  for (Size t{1}; t <= Size{3}; t += Size{1})
+  {
+    const auto table = transition_probabilities(resource, t);
+    REQUIRE(table->size() == 13);
+    for (Capacity n{0}; n <= Capacity{12}; ++n)
+    {
+      REQUIRE(
+          static_cast<double>(get((*table)[size_t(n)]))
+          == Catch::Approx(
+              static_cast<double>(get(conditional_transition_probability(n, component, t)))));
+    }
+  }
+}
+
+static Resource<Capacity>
+unequal_resource(int component_types)
+{
+  Resource<Capacity> resource;
+  for (int i = 0; i < component_types; ++i)
+  {
+    resource.add_component(Capacity{4 + 3 * i}, Count{1 + i % 2});
+  }
+  return resource;
+}
+
+TEST_CASE("combinatorial_arrangement_number_unequal, convolution", "[overflow_far]")
+{
+  for (int component_types = 2; component_types <= 4; ++component_types)
+  {
+    const auto resource = unequal_resource(component_types);
+    for (Capacity x{0}; x <= Capacity{resource.V()}; ++x)
+    {
+      REQUIRE(
+          combinatorial_arrangement_number_unequal_resources(x, resource)
+          == combinatorial_arrangement_number_unequal_resources_reference(x, resource));
+    }
+  }
+}
+
+TEST_CASE("combinatorial_arrangement_number_unequal, 3-6 types", "[.][benchmark]")
+{
+  for (int component_types = 3; component_types <= 6; ++component_types)
+  {
+    const auto resource = unequal_resource(component_types);
+    const auto x = Capacity{get(resource.V()) / 2};
+    BENCHMARK("convolution, " + std::to_string(component_types) + " types")
+    {
+      return combinatorial_arrangement_number_unequal_resources(x, resource);
+    };
+    BENCHMARK("enumeration, " + std::to_string(component_types) + " types")
+    {
+      return combinatorial_arrangement_number_unequal_resources_reference(x, resource);
+    };
+  }
+}
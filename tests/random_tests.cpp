@@ -0,0 +1,89 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "simulation/exponential.h"
+#include "simulation/random.h"
+
+#include <cmath>
+#include <set>
+
+using Simulation::Philox;
+
+// Known answers from the Random123 distribution (kat_vectors).
+TEST_CASE("philox4x32-10 known answers", "[random]")
+{
+  REQUIRE(
+      Philox::block({0, 0, 0, 0}, {0, 0})
+      == Philox::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+  REQUIRE(
+      Philox::block({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff})
+      == Philox::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+  REQUIRE(
+      Philox::block({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0})
+      == Philox::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+}
+
+TEST_CASE("philox streams are reproducible and distinct", "[random]")
+{
+  Philox a{42, 1};
+  Philox b{42, 1};
+  Philox c{42, 2};
+  Philox d{43, 1};
+
+  std::set<uint64_t> values;
+  for (int i = 0; i < 1000; ++i)
+  {
+    const auto value = a();
+    REQUIRE(value == b());
+    values.insert(value);
+    values.insert(c());
+    values.insert(d());
+  }
+  REQUIRE(values.size() == 3000);
+}
+
+TEST_CASE("replication keys are distinct", "[random]")
+{
+  std::set<uint64_t> keys;
+  for (uint64_t scenario = 0; scenario < 10; ++scenario)
+  {
+    for (uint64_t replication = 0; replication < 10; ++replication)
+    {
+      keys.insert(Simulation::replication_key(0, scenario, replication));
+    }
+  }
+  REQUIRE(keys.size() == 100);
+}
+
+TEST_CASE("ziggurat exponential moments and tail", "[random]")
+{
+  Philox     engine{7, 1};
+  const auto n = 1'000'000;
+  double     sum = 0.0;
+  double     sum_of_squares = 0.0;
+  int        above_3 = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    const auto x = Simulation::ziggurat_exponential()(engine);
+    REQUIRE(x >= 0.0);
+    sum += x;
+    sum_of_squares += x * x;
+    above_3 += x > 3.0 ? 1 : 0;
+  }
+  const auto mean = sum / n;
+  REQUIRE(mean == Catch::Approx(1.0).margin(0.005));
+  REQUIRE(sum_of_squares / n - mean * mean == Catch::Approx(1.0).margin(0.01));
+  REQUIRE(static_cast<double>(above_3) / n == Catch::Approx(std::exp(-3.0)).margin(0.001));
+}
+
+TEST_CASE("exponential sampler scales by the rate", "[random]")
+{
+  Philox                         engine{7, 2};
+  Simulation::ExponentialSampler sampler{4.0L};
+  double                         sum = 0.0;
+  for (int i = 0; i < 100'000; ++i)
+  {
+    sum += static_cast<double>(sampler(engine, Simulation::ExponentialSamplerType::Ziggurat));
+  }
+  REQUIRE(sum / 100'000 == Catch::Approx(0.25).margin(0.005));
+}
@@ -0,0 +1,223 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "calculation.h"
+#include "cli_options.h"
+#include "model/analytical.h"
+#include "scenario_settings.h"
+#include "scenarios/simple.h"
+#include "simulation/group.h"
+#include "simulation/source_stream/poisson.h"
+#include "simulation/world.h"
+#include "topology.h"
+
+#include <boost/program_options.hpp>
+#include <cmath>
+#include <iterator>
+#include <nlohmann/json.hpp>
+
+using Simulation::Capacity;
+using Simulation::Intensity;
+using Simulation::RunMode;
+using Simulation::Size;
+
+namespace {
+
+CLIOptions
+simulation_options(RunMode run_mode, long double duration)
+{
+  CLIOptions cli;
+  cli.duration = Duration{duration};
+  cli.run_mode = run_mode;
+  return cli;
+}
+
+struct ErlangRun
+{
+  nlohmann::json tc_stats;
+  bool           state_based;
+  uint64_t       leaps;
+};
+
+// Single group with the Poisson stream of the offered traffic A, the holding times have the mean 1.
+ErlangRun
+run_erlang(Intensity A, Capacity V, const CLIOptions &cli, double thinning = 1.0)
+{
+  auto scenario = erlang_model(A, V);
+  scenario.do_before = nullptr;
+  scenario.do_after = nullptr;
+  scenario.thinning = thinning;
+  run_scenario(scenario, cli, true);
+  return {
+      scenario.stats["G1"].begin().value(),
+      scenario.world->is_state_based(),
+      scenario.stats["_events"]["leaps"][0].get<uint64_t>()};
+}
+
+int64_t
+offered(const ErlangRun &run)
+{
+  return run.tc_stats["served"][0].get<int64_t>() + run.tc_stats["lost"][0].get<int64_t>()
+         + run.tc_stats["forwarded"][0].get<int64_t>();
+}
+
+double
+p_block(const ErlangRun &run)
+{
+  return run.tc_stats["P_block"][0].get<double>();
+}
+
+double
+p_loss(const ErlangRun &run)
+{
+  return run.tc_stats["P_loss"][0].get<double>();
+}
+
+// Primary group G1 in the layer 0 overflows the Poisson traffic A to the group G2 in the layer 1.
+// Returns the intensity of the requests lost by G2, the layer 0 is modelled analytically if hybrid.
+double
+overflow_loss_intensity(Intensity A, Capacity V1, Capacity V2, bool hybrid)
+{
+  ScenarioSettings scenario{"Overflow"};
+  auto            &topology = scenario.topology;
+  auto            &tc = topology.add_traffic_class(A, Intensity{1.0L}, Size{1});
+  const GroupName  g1{"G1"};
+  const GroupName  g2{"G2"};
+  const SourceName s1{"SPo1"};
+  topology.add_group(std::make_unique<Simulation::Group>(g1, V1, 0));
+  topology.add_group(std::make_unique<Simulation::Group>(g2, V2, 1));
+  topology.add_source(std::make_unique<Simulation::PoissonSourceStream>(s1, tc));
+  topology.connect_groups(g1, g2);
+  topology.attach_source_to_group(s1, g1);
+  if (hybrid)
+  {
+    Model::replace_layers_with_overflow_streams(
+        topology, {0}, Model::KaufmanRobertsVariant::FixedReqSize);
+  }
+
+  run_scenario(scenario, simulation_options(RunMode::Events, 50000.0L), true);
+  const auto &tc_stats = scenario.stats["G2"].begin().value();
+  return static_cast<double>(tc_stats["lost"][0].get<int64_t>())
+         / tc_stats["simulation_time"][0].get<double>();
+}
+
+} // namespace
+
+TEST_CASE("state-based run keeps the coupled sweep", "[simulation]")
+{
+  auto cli = simulation_options(RunMode::Auto, 20000.0L);
+  cli.coupled_sweep = true;
+
+  // Nothing is blocked, so the offered requests are the arrivals until the end of the run.
+  const Capacity V{1000};
+  const auto     full = run_erlang(Intensity{20.0L}, V, cli, 1.0);
+  const auto     thinned = run_erlang(Intensity{19.0L}, V, cli, 0.95);
+  REQUIRE(full.state_based);
+  REQUIRE(thinned.state_based);
+
+  // The arrivals of the lower point are those of the higher one without about 5% of them.
+  // Independent streams would differ by about 900 in either direction.
+  const auto missing = static_cast<double>(offered(full) - offered(thinned));
+  const auto expected = 0.05 * static_cast<double>(offered(full));
+  REQUIRE(offered(thinned) <= offered(full));
+  REQUIRE(std::abs(missing - expected) < 5.0 * std::sqrt(expected));
+
+  // The event-driven run draws the same arrivals, it only stops them at a tick.
+  cli.run_mode = RunMode::Events;
+  const auto events = run_erlang(Intensity{19.0L}, V, cli, 0.95);
+  REQUIRE(!events.state_based);
+  REQUIRE(std::abs(offered(events) - offered(thinned)) <= 10);
+}
+
+TEST_CASE("coupled sweep keeps the coupling with a random seed", "[simulation]")
+{
+  namespace po = boost::program_options;
+  const char *argv[] = {"mutosim", "--random", "1", "--coupled-sweep", "1", "--duration", "20000"};
+  po::variables_map vm;
+  po::store(
+      po::parse_command_line(static_cast<int>(std::size(argv)), argv, prepare_options_description()),
+      vm);
+  po::notify(vm);
+  const auto cli = parse_args(vm);
+  REQUIRE(cli.use_random_seed);
+  REQUIRE(cli.coupled_sweep);
+
+  // Both load points have the same stream index, as in a sweep of one scenario file, so they must
+  // get the same streams from the seed of the invocation.
+  const Capacity V{1000};
+  const auto     full = run_erlang(Intensity{20.0L}, V, cli, 1.0);
+  const auto     thinned = run_erlang(Intensity{19.0L}, V, cli, 0.95);
+  const auto     missing = static_cast<double>(offered(full) - offered(thinned));
+  const auto     expected = 0.05 * static_cast<double>(offered(full));
+  REQUIRE(offered(thinned) <= offered(full));
+  REQUIRE(std::abs(missing - expected) < 5.0 * std::sqrt(expected));
+}
+
+TEST_CASE("state-based run gives the Erlang B blocking", "[simulation]")
+{
+  const auto erlang_b = static_cast<double>(erlang_block_probability(5.0L, 8));
+
+  const auto events =
+      run_erlang(Intensity{5.0L}, Capacity{8}, simulation_options(RunMode::Events, 50000.0L));
+  const auto states =
+      run_erlang(Intensity{5.0L}, Capacity{8}, simulation_options(RunMode::States, 50000.0L));
+  REQUIRE(states.state_based);
+
+  // About 17500 losses, the relative standard error is about 1%.
+  REQUIRE(Catch::Approx(erlang_b).epsilon(0.05) == p_block(events));
+  REQUIRE(Catch::Approx(erlang_b).epsilon(0.05) == p_loss(events));
+  REQUIRE(Catch::Approx(erlang_b).epsilon(0.05) == p_block(states));
+  REQUIRE(Catch::Approx(erlang_b).epsilon(0.05) == p_loss(states));
+  REQUIRE(Catch::Approx(p_block(events)).epsilon(0.05) == p_block(states));
+}
+
+TEST_CASE("tau-leaping gives the Erlang B blocking of a large group", "[simulation]")
+{
+  const auto erlang_b = static_cast<double>(erlang_block_probability(950.0L, 1000));
+
+  const auto events =
+      run_erlang(Intensity{950.0L}, Capacity{1000}, simulation_options(RunMode::Events, 2000.0L));
+  const auto leaps =
+      run_erlang(Intensity{950.0L}, Capacity{1000}, simulation_options(RunMode::Leaps, 2000.0L));
+  REQUIRE(leaps.state_based);
+  REQUIRE(leaps.leaps > 0);
+
+  // E_1000(950) = 0.00365, the relative standard error of a run is about 5%.
+  REQUIRE(Catch::Approx(erlang_b).epsilon(0.15) == p_block(events));
+  REQUIRE(Catch::Approx(erlang_b).epsilon(0.15) == p_block(leaps));
+  REQUIRE(Catch::Approx(erlang_b).epsilon(0.15) == p_loss(leaps));
+  REQUIRE(Catch::Approx(p_block(events)).epsilon(0.2) == p_block(leaps));
+}
+
+TEST_CASE("RESTART gives the Erlang B blocking of a rare state", "[simulation]")
+{
+  const auto erlang_b = static_cast<double>(erlang_block_probability(5.0L, 15));
+
+  auto cli = simulation_options(RunMode::States, 50000.0L);
+  cli.restart.thresholds = {8.0, 11.0, 13.0};
+  cli.restart.retrials = {4};
+  const auto restart = run_erlang(Intensity{5.0L}, Capacity{15}, cli);
+  REQUIRE(restart.state_based);
+
+  // E_15(5) = 0.000157, the plain run of that length has the relative standard error of about 15%,
+  // the retrials bring it down several times.
+  const auto p_block_restart = restart.tc_stats["P_block_restart"][0].get<double>();
+  const auto half_width = restart.tc_stats["P_block_restart_hw"][0].get<double>();
+  REQUIRE(Catch::Approx(erlang_b).epsilon(0.2) == p_block_restart);
+  REQUIRE(half_width < 0.2 * erlang_b);
+}
+
+TEST_CASE("hybrid run gives the loss of the overflow system", "[simulation]")
+{
+  // The requests are lost when both groups are full, as in the single group of V1 + V2.
+  const auto lost = 5.0 * static_cast<double>(erlang_block_probability(5.0L, 10));
+
+  const auto events = overflow_loss_intensity(Intensity{5.0L}, Capacity{5}, Capacity{5}, false);
+  const auto hybrid = overflow_loss_intensity(Intensity{5.0L}, Capacity{5}, Capacity{5}, true);
+
+  // About 4600 losses in bursts, the relative standard error is about 2.5%. The interrupted
+  // Poisson stream is an approximation of the overflow stream, here it overestimates the loss
+  // by about 5%.
+  REQUIRE(Catch::Approx(lost).epsilon(0.1) == events);
+  REQUIRE(Catch::Approx(lost).epsilon(0.15) == hybrid);
+}
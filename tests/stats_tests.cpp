@@ -0,0 +1,138 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "math_utils.h"
+#include "simulation/stats.h"
+
+#include <cmath>
+#include <vector>
+
+TEST_CASE("student_t_95", "[math]")
+{
+  REQUIRE(Catch::Approx(12.706) == Math::student_t_95(1));
+  REQUIRE(Catch::Approx(2.262) == Math::student_t_95(9));
+  REQUIRE(Catch::Approx(2.042) == Math::student_t_95(30));
+  REQUIRE(Math::student_t_95(35) >= Math::student_t_95(40));
+  REQUIRE(Math::student_t_95(1000) > 1.96);
+}
+
+TEST_CASE("batch means confidence interval", "[stats]")
+{
+  Simulation::BatchMeans batches;
+  REQUIRE(std::isinf(batches.half_width()));
+
+  batches.add(0.1);
+  REQUIRE(std::isinf(batches.half_width()));
+
+  for (auto value : {0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0})
+  {
+    batches.add(value);
+  }
+  REQUIRE(batches.size() == 10);
+  REQUIRE(Catch::Approx(0.55) == batches.mean());
+  // s = sqrt(11/120), t_9 = 2.262
+  REQUIRE(Catch::Approx(2.262 * std::sqrt(11.0 / 120.0 / 10.0)) == batches.half_width());
+  REQUIRE(Catch::Approx(batches.half_width() / 0.55) == batches.relative_half_width());
+}
+
+TEST_CASE("batch means of zeros have no relative precision", "[stats]")
+{
+  Simulation::BatchMeans batches;
+  for (int i = 0; i < 10; ++i)
+  {
+    batches.add(0.0);
+  }
+  REQUIRE(0.0 == batches.half_width());
+  REQUIRE(std::isinf(batches.relative_half_width()));
+}
+
+TEST_CASE("block stats reset keeps the ongoing block", "[stats]")
+{
+  Simulation::BlockStats block_stats;
+  block_stats.try_block(Time{1.0L});
+  block_stats.try_unblock(Time{3.0L});
+  block_stats.try_block(Time{5.0L});
+  REQUIRE(Catch::Approx(4.0) == static_cast<double>(ts::get(block_stats.block_time_until(Time{7.0L}))));
+
+  block_stats.reset(Time{6.0L});
+  REQUIRE(Catch::Approx(1.0) == static_cast<double>(ts::get(block_stats.block_time_until(Time{7.0L}))));
+  block_stats.try_unblock(Time{8.0L});
+  REQUIRE(Catch::Approx(2.0) == static_cast<double>(ts::get(block_stats.block_time)));
+}
+
+TEST_CASE("mser truncation point", "[stats]")
+{
+  std::vector<double> series;
+  for (int i = 0; i < 50; ++i)
+  {
+    series.push_back(i);
+  }
+  for (int i = 0; i < 200; ++i)
+  {
+    series.push_back(100.0 + i % 2);
+  }
+  REQUIRE(Simulation::mser_truncation(series) == 50);
+}
+
+TEST_CASE("mser of a steady series does not truncate", "[stats]")
+{
+  std::vector<double> series;
+  for (int i = 0; i < 250; ++i)
+  {
+    series.push_back(100.0 + i % 3);
+  }
+  REQUIRE(Simulation::mser_truncation(series) == 0);
+}
+
+TEST_CASE("mser of a trend is not in the steady state", "[stats]")
+{
+  std::vector<double> series;
+  for (int i = 0; i < 250; ++i)
+  {
+    series.push_back(i);
+  }
+  REQUIRE_FALSE(Simulation::mser_truncation(series).has_value());
+  REQUIRE_FALSE(Simulation::mser_truncation({1.0, 2.0, 3.0}).has_value());
+}
+
+TEST_CASE("control variate removes the linear dependence", "[stats]")
+{
+  std::vector<double>              values;
+  std::vector<std::vector<double>> controls;
+  for (int i = 0; i < 10; ++i)
+  {
+    const auto control = (i % 2 == 0 ? 1.0 : -1.0) * (1.0 + 0.1 * i);
+    values.push_back(0.25 + 2.0 * control);
+    controls.push_back({control});
+  }
+  const auto estimate = Simulation::control_variate_estimate(values, controls);
+  REQUIRE(estimate.has_value());
+  REQUIRE(Catch::Approx(0.25) == estimate->mean);
+  REQUIRE(estimate->half_width == Catch::Approx(0.0).margin(1e-9));
+  REQUIRE(estimate->variance_reduction > 1e6);
+}
+
+TEST_CASE("control variate without controls is the batch mean", "[stats]")
+{
+  Simulation::BatchMeans batches;
+  std::vector<double>    values{0.1, 0.3, 0.2, 0.4, 0.25};
+  for (auto value : values)
+  {
+    batches.add(value);
+  }
+  const auto estimate =
+      Simulation::control_variate_estimate(values, std::vector<std::vector<double>>(5));
+  REQUIRE(estimate.has_value());
+  REQUIRE(Catch::Approx(batches.mean()) == estimate->mean);
+  REQUIRE(Catch::Approx(batches.half_width()) == estimate->half_width);
+  REQUIRE(Catch::Approx(1.0) == estimate->variance_reduction);
+}
+
+TEST_CASE("control variate needs enough independent batches", "[stats]")
+{
+  REQUIRE_FALSE(
+      Simulation::control_variate_estimate({1.0, 2.0, 3.0}, {{0.1}, {0.2}, {0.3}}).has_value());
+  REQUIRE_FALSE(Simulation::control_variate_estimate(
+                    {1.0, 2.0, 3.0, 4.0, 5.0}, {{1.0}, {1.0}, {1.0}, {1.0}, {1.0}})
+                    .has_value());
+}
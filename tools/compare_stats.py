@@ -0,0 +1,87 @@
+#!/usr/bin/env python
+"""
+Compare the stats of an approximate run with the stats of a reference run.
+
+Usage: compare_stats.py reference.json approximate.json [P_block P_loss ...]
+
+For every scenario file, intensity, group and traffic class present in both
+files prints the mean of each quantity over the repeats, the relative bias of
+the approximate run and the bias in units of the half-width of the 95%
+confidence interval of the reference run (when the reference run had epochs).
+The scenarios of a hybrid run (";hybrid" suffix) are compared with the same
+scenarios of the reference run. The last lines give the speedup, the ratio of
+the summed run times of the compared intensities, and the largest absolute
+relative bias of every quantity.
+
+"""
+
+import sys
+import json
+
+
+def mean(values):
+    values = [v for v in values if v is not None]
+    return sum(values) / len(values) if values else None
+
+
+def run_time(stats):
+    return sum(stats.get('_events', {}).get('run_time', []))
+
+
+def compare(reference, approximate, quantities):
+    approximate = {filename[:-len(';hybrid')] if filename.endswith(';hybrid') else filename: scenario
+                   for filename, scenario in approximate.items()}
+    worst = {q: 0.0 for q in quantities}
+    reference_time = 0.0
+    approximate_time = 0.0
+    for filename, scenario in sorted(reference.items()):
+        for A, stats in sorted(scenario.items()):
+            if A.startswith('_'):
+                continue
+            other_stats = approximate.get(filename, {}).get(A)
+            if other_stats is None:
+                continue
+            reference_time += run_time(stats)
+            approximate_time += run_time(other_stats)
+            for group, tcs in sorted(stats.items()):
+                if group.startswith('_') or not isinstance(tcs, dict):
+                    continue
+                for tc, values in sorted(tcs.items()):
+                    other_values = other_stats.get(group, {}).get(tc)
+                    if other_values is None:
+                        continue
+                    for q in quantities:
+                        if q not in values or q not in other_values:
+                            continue
+                        exact = mean(values[q])
+                        approx = mean(other_values[q])
+                        if exact is None or approx is None:
+                            continue
+                        bias = (approx - exact) / exact if exact > 0 else float('nan')
+                        half_width = mean(values.get(q + '_hw', []))
+                        in_hw = ((approx - exact) / half_width
+                                 if half_width and half_width > 0 else float('nan'))
+                        if bias == bias:
+                            worst[q] = max(worst[q], abs(bias))
+                        print("{} A={} {} tc={} {}: {:.6e} {:.6e} bias {:+.3%} ({:+.2f} hw)".format(
+                            filename, A, group, tc, q, exact, approx, bias, in_hw))
+    if approximate_time > 0:
+        print("Speedup: {:.2f}".format(reference_time / approximate_time))
+    print("Largest relative bias: " + ", ".join(
+        "{} {:.3%}".format(q, worst[q]) for q in quantities))
+
+
+def main():
+    args = sys.argv[1:]
+    if len(args) < 2:
+        print(__doc__)
+        sys.exit(1)
+    with open(args[0], 'rb') as fp:
+        reference = json.load(fp)
+    with open(args[1], 'rb') as fp:
+        approximate = json.load(fp)
+    compare(reference, approximate, args[2:] or ['P_block', 'P_loss'])
+
+
+if __name__ == "__main__":
+    main()
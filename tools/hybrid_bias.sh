@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# Compares the hybrid simulation, with the primary layer replaced by the
+# synthetic overflow streams of the analytical model, against the full
+# simulation on the reference set of scenarios. Prints the speedup and the
+# discrepancy of the simulated groups.
+
+OUTPUT_DIR=data/tests/hybrid
+ARGS="-m simulation -c1 --start 0.4 --stop 1.8 --step 0.1 -t 100000 --epoch-duration 1000 --parallel=true -r0 -q1 -d $OUTPUT_DIR"
+SCENARIOS_DIR=data/scenarios/analytical
+HYBRID_LAYERS=${HYBRID_LAYERS:-0}
+
+SCENARIOS=(const_ratio/3_1g_126_60.json var_ratio/3_1g_126_60.json 1ov/3_1g_126_60.json 3ov/3_1g_126_60.json)
+
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+mkdir -p $OUTPUT_DIR
+for SCENARIO in ${SCENARIOS[@]}; do
+  NAME=$(echo $SCENARIO | tr '/' '_')
+  echo -e "Scenario ${BLUE}$SCENARIO${NC}"
+  ../mutosim_build/bin/mutosim -f $SCENARIOS_DIR/$SCENARIO $ARGS --run-mode events -o ${NAME}_full.json > /dev/null
+  ../mutosim_build/bin/mutosim -f $SCENARIOS_DIR/$SCENARIO $ARGS --run-mode events --hybrid-layers $HYBRID_LAYERS -o ${NAME}_hybrid.json > /dev/null
+  python tools/compare_stats.py $OUTPUT_DIR/${NAME}_full.json $OUTPUT_DIR/${NAME}_hybrid.json | tail -n 2
+done
@@ -0,0 +1,24 @@
+#!/bin/bash
+
+# Estimates the bias of the leaps run mode against the exact state-based run on
+# the reference set of scenarios. Both runs use the same seeds and epochs, so the
+# reference run gives the confidence intervals of the comparison.
+
+OUTPUT_DIR=data/tests/leaps
+ARGS="-m simulation -c1 --start 0.4 --stop 1.8 --step 0.1 -t 100000 --epoch-duration 1000 --parallel=true -r0 -q1 -d $OUTPUT_DIR"
+SCENARIOS_DIR=data/scenarios/analytical
+EPSILON=${EPSILON:-0.1}
+
+SCENARIOS=(const_ratio/3_1g_126_60.json var_ratio/3_1g_126_60.json 1ov/3_1g_126_60.json 3ov/3_1g_126_60.json)
+
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+mkdir -p $OUTPUT_DIR
+for SCENARIO in ${SCENARIOS[@]}; do
+  NAME=$(echo $SCENARIO | tr '/' '_')
+  echo -e "Scenario ${BLUE}$SCENARIO${NC}"
+  ../mutosim_build/bin/mutosim -f $SCENARIOS_DIR/$SCENARIO $ARGS --run-mode states -o ${NAME}_states.json > /dev/null
+  ../mutosim_build/bin/mutosim -f $SCENARIOS_DIR/$SCENARIO $ARGS --run-mode leaps --leap-epsilon $EPSILON -o ${NAME}_leaps.json > /dev/null
+  python tools/compare_stats.py $OUTPUT_DIR/${NAME}_states.json $OUTPUT_DIR/${NAME}_leaps.json | tail -n 1
+done